@@ -0,0 +1,191 @@
+// benchmarks for the FFT, the phase vocoder and WAV I/O (no Juce UI)
+#include "../Source/FourierTransformer.hpp"
+#include "../Source/PitchShifter.hpp"
+#include "../Source/SampleBuffer.hpp"
+#include "../Source/WaveFile.hpp"
+#include "../Source/WaveWriter.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// throughput is counted in samples per channel, so a stereo clip counts once per frame
+// it is also reported as a real-time factor at this rate
+// (how many seconds of audio are processed per second)
+static const double SAMPLE_RATE = 44100.0;
+
+// every benchmark is repeated until it has run for at least this long
+static const double MIN_SECONDS = 0.5;
+
+struct Result
+{
+    std::string name;
+    std::string parameters;
+    uint64_t numSamples;
+    double seconds;
+};
+
+// runs body until MIN_SECONDS have passed, body returns the number of samples it processed
+Result measure(const std::string& name, const std::string& parameters, const std::function<uint64_t()>& body)
+{
+    // one untimed run, so caches and lazily built state don't count
+    body();
+
+    uint64_t numSamples = 0;
+    double seconds = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (seconds < MIN_SECONDS)
+    {
+        numSamples += body();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double samplesPerSecond = numSamples / seconds;
+    std::printf("%-8s %-36s %14.0f samples/s %10.1fx real time\n",
+        name.c_str(), parameters.c_str(), samplesPerSecond, samplesPerSecond / SAMPLE_RATE);
+    return { name, parameters, numSamples, seconds };
+}
+
+// a deterministic stereo test clip (a chord with a slow decay and some noise)
+std::string writeTestClip(const std::string& filename, double lengthSeconds, uint32_t bitsPerSample, bool ieeeFloat)
+{
+    uint64_t numSamples = (uint64_t) (lengthSeconds * SAMPLE_RATE);
+    SampleBuffer samples(2, numSamples);
+    uint32_t noise = 1;
+    for (uint64_t i = 0; i < numSamples; i++)
+    {
+        double t = i / SAMPLE_RATE;
+        double decay = std::exp(-t);
+        double chord = std::sin(2 * M_PI * 220.0 * t) + std::sin(2 * M_PI * 277.2 * t) + std::sin(2 * M_PI * 329.6 * t);
+        noise = noise * 1664525 + 1013904223;
+        double hiss = (noise >> 8) / 16777216.0 - 0.5;
+        samples.getChannel(0)[i] = 0.25 * decay * chord + 0.01 * hiss;
+        samples.getChannel(1)[i] = 0.25 * decay * chord - 0.01 * hiss;
+    }
+
+    WaveWriter writer(filename, 2, (uint32_t) SAMPLE_RATE, bitsPerSample, ieeeFloat, numSamples);
+    const double* channels[2] = { samples.getChannel(0), samples.getChannel(1) };
+    writer.write(channels, numSamples);
+    writer.close();
+    return filename;
+}
+
+void benchmarkFourierTransformer(std::vector<Result>& results)
+{
+    for (uint32_t size = 256; size <= 16384; size *= 2)
+    {
+        FourierTransformer transformer(size);
+        std::vector<std::complex<double>> input(size);
+        std::vector<std::complex<double>> output(size);
+        std::vector<std::complex<double>> buffer(size);
+        for (uint32_t i = 0; i < size; i++)
+        {
+            input[i] = std::sin(2 * M_PI * 7 * i / size);
+        }
+
+        std::string parameters = "size=" + std::to_string(size);
+        results.push_back(measure("fft", parameters, [&]
+            {
+                transformer.fft(input.data(), output.data(), buffer.data(), size);
+                return (uint64_t) size;
+            }));
+        results.push_back(measure("ifft", parameters, [&]
+            {
+                transformer.ifft(output.data(), input.data(), buffer.data(), size);
+                return (uint64_t) size;
+            }));
+    }
+}
+
+void benchmarkPitchShifter(std::vector<Result>& results, const std::string& clipFilename)
+{
+    // the demo uses 8192 frames, the plugin 4096 for the keyboard and 512 to 4096 for live input
+    // all of them with an overlap factor of 4
+    const WaveFile clip(clipFilename);
+    for (int frameSize : { 512, 1024, 2048, 4096, 8192 })
+    {
+        PitchShifter shifter(frameSize, 4);
+        for (int steps : { -12, -1, 1, 11 })
+        {
+            std::string parameters = "frameSize=" + std::to_string(frameSize) + " overlap=4 steps=" + std::to_string(steps);
+            results.push_back(measure("shift", parameters, [&]
+                {
+                    WaveFile file = clip;
+                    shifter.shift(file, steps);
+                    return file.numSamples;
+                }));
+        }
+    }
+}
+
+void benchmarkWaveFile(std::vector<Result>& results, const std::string& directory)
+{
+    struct Format
+    {
+        uint32_t bitsPerSample;
+        bool ieeeFloat;
+    };
+
+    for (Format format : { Format{ 8, false }, Format{ 16, false }, Format{ 24, false }, Format{ 32, false }, Format{ 32, true } })
+    {
+        std::string parameters = "bits=" + std::to_string(format.bitsPerSample) + (format.ieeeFloat ? " float" : " pcm");
+        std::string filename = directory + "/benchmark-" + std::to_string(format.bitsPerSample)
+            + (format.ieeeFloat ? "f" : "") + ".wav";
+        writeTestClip(filename, 10.0, format.bitsPerSample, format.ieeeFloat);
+
+        results.push_back(measure("decode", parameters, [&]
+            {
+                WaveFile file(filename);
+                return file.numSamples;
+            }));
+
+        WaveFile file(filename);
+        std::string outputFilename = filename + ".out.wav";
+        results.push_back(measure("encode", parameters, [&]
+            {
+                file.write(outputFilename, format.bitsPerSample, format.ieeeFloat);
+                return file.numSamples;
+            }));
+        std::remove(outputFilename.c_str());
+        std::remove(filename.c_str());
+    }
+}
+
+void writeJson(const std::vector<Result>& results, const std::string& filename)
+{
+    std::ofstream output(filename);
+    output << "{\n  \"sampleRate\": " << SAMPLE_RATE << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const Result& result = results[i];
+        double samplesPerSecond = result.numSamples / result.seconds;
+        output << "    { \"name\": \"" << result.name << "\", \"parameters\": \"" << result.parameters
+            << "\", \"samples\": " << result.numSamples << ", \"seconds\": " << result.seconds
+            << ", \"samplesPerSecond\": " << samplesPerSecond
+            << ", \"realTimeFactor\": " << samplesPerSecond / SAMPLE_RATE << " }"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    output << "  ]\n}\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::string outputFilename = argc >= 2 ? argv[1] : "benchmark.json";
+    std::string directory = argc >= 3 ? argv[2] : ".";
+
+    std::vector<Result> results;
+    benchmarkFourierTransformer(results);
+    benchmarkPitchShifter(results, writeTestClip(directory + "/benchmark-clip.wav", 5.0, 16, false));
+    std::remove((directory + "/benchmark-clip.wav").c_str());
+    benchmarkWaveFile(results, directory);
+
+    writeJson(results, outputFilename);
+    std::cout << "Results written to " << outputFilename << std::endl;
+    return 0;
+}
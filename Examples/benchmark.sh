@@ -0,0 +1,19 @@
+#!/bin/bash
+
+# the following script compiles the benchmarks with optimisations
+# and writes their results to benchmark.json, so that builds can be compared
+
+echo "Compiling ..."
+g++ -O2 benchmark.cpp \
+    ../Source/FourierTransformer.cpp \
+    ../Source/PitchShifter.cpp \
+    ../Source/Profiler.cpp \
+    ../Source/RenderCache.cpp \
+    ../Source/SampleBuffer.cpp \
+    ../Source/ThreadPool.cpp \
+    ../Source/WaveFile.cpp \
+    ../Source/WaveReader.cpp \
+    ../Source/WaveWriter.cpp -o benchmark
+
+echo "Running benchmarks ..."
+./benchmark ${1:-benchmark.json}
@@ -0,0 +1,319 @@
+// checks that the pitch shifter still reproduces the files in results (no Juce UI)
+// every sample/step pair in demo.sh is shifted by each engine configuration,
+// compared against its golden file and timed
+#include "../Source/FourierTransformer.hpp"
+#include "../Source/PitchShifter.hpp"
+#include "../Source/SampleBuffer.hpp"
+#include "../Source/ThreadPool.hpp"
+#include "../Source/WaveFile.hpp"
+#include "../Source/WaveReader.hpp"
+#include "../Source/WaveWriter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// the goldens were rendered by demo.cpp with these settings
+static const int FRAME_SIZE = 8192;
+static const int OVERLAP_FACTOR = 4;
+
+// the spectral distance compares Hann windowed frames of this size, half overlapped
+// power below the floor (-100 dB) counts as the floor, so silence does not dominate
+static const uint32_t SPECTRUM_SIZE = 2048;
+static const double POWER_FLOOR = 1e-10;
+
+// an identical output has an infinite SNR, which is reported as this
+static const double MAX_SNR = 200.0;
+
+struct Case
+{
+    int steps;
+    std::string input;
+    std::string golden;
+};
+
+// one way of running the engine, which shifts input into output by steps
+// optimisations are added here, and have to reproduce the goldens as well as "streaming" does
+struct Configuration
+{
+    std::string name;
+    std::string description;
+    std::function<void(const std::string&, const std::string&, int)> run;
+};
+
+struct Result
+{
+    std::string configuration;
+    const Case* testCase;
+    double seconds;
+    double snr;
+    double spectralDistance;
+    bool sameLength;
+    bool passed;
+};
+
+std::vector<Configuration> getConfigurations()
+{
+    return {
+        { "streaming", "WaveReader -> PitchShifter -> WaveWriter, I/O on the shared pool",
+            [](const std::string& input, const std::string& output, int steps)
+            {
+                WaveReader reader(input);
+                WaveWriter writer(output, reader.numChannels, reader.sampleRate,
+                    reader.getBitsPerSample(), reader.isIeeeFloat(), reader.numSamples);
+                reader.setThreadPool(&ThreadPool::getShared());
+                writer.setThreadPool(&ThreadPool::getShared());
+                PitchShifter shifter(FRAME_SIZE, OVERLAP_FACTOR);
+                shifter.shift(reader, writer, steps);
+                writer.close();
+            } },
+        { "streaming-single-thread", "same as streaming, with all I/O on the calling thread",
+            [](const std::string& input, const std::string& output, int steps)
+            {
+                WaveReader reader(input);
+                WaveWriter writer(output, reader.numChannels, reader.sampleRate,
+                    reader.getBitsPerSample(), reader.isIeeeFloat(), reader.numSamples);
+                PitchShifter shifter(FRAME_SIZE, OVERLAP_FACTOR);
+                shifter.shift(reader, writer, steps);
+                writer.close();
+            } },
+        { "pipelined", "same as streaming, with decoding, shifting and encoding on 3 threads (as demo.cpp)",
+            [](const std::string& input, const std::string& output, int steps)
+            {
+                WaveReader reader(input);
+                WaveWriter writer(output, reader.numChannels, reader.sampleRate,
+                    reader.getBitsPerSample(), reader.isIeeeFloat(), reader.numSamples);
+                reader.setThreadPool(&ThreadPool::getShared());
+                writer.setThreadPool(&ThreadPool::getShared());
+                PitchShifter shifter(FRAME_SIZE, OVERLAP_FACTOR);
+                shifter.shiftPipelined(reader, writer, steps);
+                writer.close();
+            } },
+        { "in-memory", "WaveFile decoded whole, shifted in place and written back",
+            [](const std::string& input, const std::string& output, int steps)
+            {
+                WaveFile file(input);
+                PitchShifter shifter(FRAME_SIZE, OVERLAP_FACTOR);
+                shifter.shift(file, steps);
+                file.write(output);
+            } },
+    };
+}
+
+// the pairs are taken from the lines of demo.sh that run ./windigo, so both always agree
+std::vector<Case> readCases(const std::string& script)
+{
+    std::vector<Case> cases;
+    std::ifstream input(script);
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::istringstream words(line);
+        std::string command;
+        Case testCase;
+        if (words >> command && command == "./windigo" && words >> testCase.steps >> testCase.input >> testCase.golden)
+        {
+            cases.push_back(testCase);
+        }
+    }
+    return cases;
+}
+
+double getSignalToNoiseRatio(const WaveFile& output, const WaveFile& golden, uint64_t numSamples)
+{
+    double signal = 0.0;
+    double noise = 0.0;
+    for (uint32_t channel = 0; channel < golden.numChannels; channel++)
+    {
+        const double* expected = golden.samples.getChannel(channel);
+        const double* actual = output.samples.getChannel(channel);
+        for (uint64_t i = 0; i < numSamples; i++)
+        {
+            signal += expected[i] * expected[i];
+            noise += (actual[i] - expected[i]) * (actual[i] - expected[i]);
+        }
+    }
+    if (noise == 0.0)
+    {
+        return MAX_SNR;
+    }
+    return std::min(MAX_SNR, 10.0 * std::log10(std::max(signal, std::numeric_limits<double>::min()) / noise));
+}
+
+// log-spectral distance in dB: the RMS difference between the power spectra of each frame, averaged over frames
+double getSpectralDistance(const WaveFile& output, const WaveFile& golden, uint64_t numSamples)
+{
+    FourierTransformer transformer(SPECTRUM_SIZE);
+    std::vector<double> window(SPECTRUM_SIZE);
+    for (uint32_t k = 0; k < SPECTRUM_SIZE; k++)
+    {
+        window[k] = 0.5 - 0.5 * std::cos(2.0 * M_PI * k / SPECTRUM_SIZE);
+    }
+
+    std::vector<std::complex<double>> frame(SPECTRUM_SIZE);
+    std::vector<std::complex<double>> expectedSpectrum(SPECTRUM_SIZE);
+    std::vector<std::complex<double>> actualSpectrum(SPECTRUM_SIZE);
+    std::vector<std::complex<double>> buffer(SPECTRUM_SIZE);
+    double total = 0.0;
+    uint64_t numFrames = 0;
+    for (uint32_t channel = 0; channel < golden.numChannels; channel++)
+    {
+        for (uint64_t start = 0; start < numSamples; start += SPECTRUM_SIZE / 2)
+        {
+            // the last frame is zero padded
+            for (const WaveFile* file : { &golden, &output })
+            {
+                const double* samples = file->samples.getChannel(channel);
+                for (uint32_t k = 0; k < SPECTRUM_SIZE; k++)
+                {
+                    frame[k] = start + k < numSamples ? samples[start + k] * window[k] : 0.0;
+                }
+                transformer.fft(frame.data(), file == &golden ? expectedSpectrum.data() : actualSpectrum.data(),
+                    buffer.data(), SPECTRUM_SIZE);
+            }
+
+            // the spectrum of a real signal is symmetric, so only the bins up to Nyquist are compared
+            double sum = 0.0;
+            for (uint32_t k = 0; k <= SPECTRUM_SIZE / 2; k++)
+            {
+                double expected = 10.0 * std::log10(std::max(std::norm(expectedSpectrum[k]), POWER_FLOOR));
+                double actual = 10.0 * std::log10(std::max(std::norm(actualSpectrum[k]), POWER_FLOOR));
+                sum += (actual - expected) * (actual - expected);
+            }
+            total += std::sqrt(sum / (SPECTRUM_SIZE / 2 + 1));
+            numFrames++;
+        }
+    }
+    return numFrames > 0 ? total / numFrames : 0.0;
+}
+
+void writeJson(const std::vector<Result>& results, double minSnr, double maxSpectralDistance, const std::string& filename)
+{
+    std::ofstream output(filename);
+    output << "{\n  \"minSnr\": " << minSnr << ",\n  \"maxSpectralDistance\": " << maxSpectralDistance
+        << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const Result& result = results[i];
+        output << "    { \"configuration\": \"" << result.configuration << "\", \"input\": \"" << result.testCase->input
+            << "\", \"steps\": " << result.testCase->steps << ", \"golden\": \"" << result.testCase->golden
+            << "\", \"seconds\": " << result.seconds << ", \"snr\": " << result.snr
+            << ", \"spectralDistance\": " << result.spectralDistance
+            << ", \"sameLength\": " << (result.sameLength ? "true" : "false")
+            << ", \"passed\": " << (result.passed ? "true" : "false") << " }"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    output << "  ]\n}\n";
+}
+
+int main(int argc, char** argv)
+{
+    // ./conformance [--min-snr dB] [--max-distance dB] [--json file] [--tmp directory] [configuration ...]
+    // the goldens are quantised to their own bit depth, so an exact engine scores MAX_SNR and 0 dB,
+    // and anything that changes the output beyond rounding fails
+    double minSnr = 60.0;
+    double maxSpectralDistance = 0.5;
+    std::string jsonFilename = "conformance.json";
+    std::string directory = ".";
+    std::vector<std::string> names;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--min-snr" && i + 1 < argc)
+        {
+            minSnr = std::stod(argv[++i]);
+        }
+        else if (argument == "--max-distance" && i + 1 < argc)
+        {
+            maxSpectralDistance = std::stod(argv[++i]);
+        }
+        else if (argument == "--json" && i + 1 < argc)
+        {
+            jsonFilename = argv[++i];
+        }
+        else if (argument == "--tmp" && i + 1 < argc)
+        {
+            directory = argv[++i];
+        }
+        else
+        {
+            names.push_back(argument);
+        }
+    }
+
+    std::vector<Configuration> configurations;
+    for (const Configuration& configuration : getConfigurations())
+    {
+        if (names.empty() || std::find(names.begin(), names.end(), configuration.name) != names.end())
+        {
+            configurations.push_back(configuration);
+        }
+    }
+    std::vector<Case> cases = readCases("demo.sh");
+    if (configurations.empty() || cases.empty())
+    {
+        std::cerr << "Nothing to run, check the configuration names and that demo.sh is in the working directory" << std::endl;
+        return 1;
+    }
+
+    // the first configuration is the baseline that the speedups are relative to
+    std::vector<Result> results;
+    std::string outputFilename = directory + "/conformance-output.wav";
+    double baselineSeconds = 0.0;
+    bool allPassed = true;
+    for (const Configuration& configuration : configurations)
+    {
+        std::cout << configuration.name << ": " << configuration.description << std::endl;
+        double totalSeconds = 0.0;
+        int numPassed = 0;
+        for (const Case& testCase : cases)
+        {
+            auto start = std::chrono::steady_clock::now();
+            configuration.run(testCase.input, outputFilename, testCase.steps);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            totalSeconds += seconds;
+
+            // the 24 and 32-bit goldens were written as 16-bit, before the demo kept the input's format,
+            // so the output is quantised the same way before it is compared
+            WaveFile output(outputFilename);
+            WaveFile golden(testCase.golden);
+            if (output.getBitsPerSample() != golden.getBitsPerSample() || output.isIeeeFloat() != golden.isIeeeFloat())
+            {
+                output.write(outputFilename, golden.getBitsPerSample(), golden.isIeeeFloat());
+                output = WaveFile(outputFilename);
+            }
+            uint64_t numSamples = std::min(output.numSamples, golden.numSamples);
+            bool sameLength = output.numSamples == golden.numSamples && output.numChannels == golden.numChannels;
+            double snr = sameLength ? getSignalToNoiseRatio(output, golden, numSamples) : 0.0;
+            double distance = sameLength ? getSpectralDistance(output, golden, numSamples) : 0.0;
+            bool passed = sameLength && snr >= minSnr && distance <= maxSpectralDistance;
+            numPassed += passed;
+
+            std::printf("  %-4s %-40s %+3d %9.3f s %8.1f dB SNR %8.3f dB distance%s\n", passed ? "ok" : "FAIL",
+                testCase.input.c_str(), testCase.steps, seconds, snr, distance, sameLength ? "" : " (length differs)");
+            results.push_back({ configuration.name, &testCase, seconds, snr, distance, sameLength, passed });
+        }
+
+        if (baselineSeconds == 0.0)
+        {
+            baselineSeconds = totalSeconds;
+        }
+        std::printf("  %d/%d passed in %.3f s, %.2fx the speed of %s\n\n", numPassed, (int) cases.size(),
+            totalSeconds, baselineSeconds / totalSeconds, configurations[0].name.c_str());
+        allPassed = allPassed && numPassed == (int) cases.size();
+    }
+    std::remove(outputFilename.c_str());
+
+    writeJson(results, minSnr, maxSpectralDistance, jsonFilename);
+    std::cout << "Results written to " << jsonFilename << std::endl;
+    return allPassed ? 0 : 1;
+}
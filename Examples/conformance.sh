@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# the following script compiles the conformance harness with optimisations,
+# shifts every sample in demo.sh with each engine configuration
+# and checks the output against the results directory, writing the metrics to conformance.json
+# any arguments (tolerances, configuration names) are passed on to the harness
+
+echo "Compiling ..."
+g++ -O2 conformance.cpp \
+    ../Source/FourierTransformer.cpp \
+    ../Source/PitchShifter.cpp \
+    ../Source/Profiler.cpp \
+    ../Source/RenderCache.cpp \
+    ../Source/SampleBuffer.cpp \
+    ../Source/ThreadPool.cpp \
+    ../Source/WaveFile.cpp \
+    ../Source/WaveReader.cpp \
+    ../Source/WaveWriter.cpp -o conformance
+
+echo "Checking against results ..."
+./conformance "$@"
@@ -1,22 +1,371 @@
 // PitchShifter original main for demo (no Juce UI)
 #include "../Source/FourierTransformer.hpp"
 #include "../Source/PitchShifter.hpp"
+#include "../Source/Profiler.hpp"
+#include "../Source/RenderCache.hpp"
+#include "../Source/SampleBuffer.hpp"
+#include "../Source/ThreadPool.hpp"
 #include "../Source/WaveFile.hpp"
+#include "../Source/WaveReader.hpp"
+#include "../Source/WaveWriter.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
-int main(int argc, char** argv)
+// every file and step is shifted with the same frame size and overlap
+static const int FRAME_SIZE = 8192;
+static const int OVERLAP_FACTOR = 4;
+
+// steps are a comma separated list of steps and inclusive ranges, e.g. -12..11 or -1,0,1
+std::vector<int> parseSteps(const std::string& list)
+{
+    std::vector<int> steps;
+    std::size_t start = 0;
+    while (start < list.size())
+    {
+        std::size_t end = std::min(list.find(',', start), list.size());
+        std::string item = list.substr(start, end - start);
+        std::size_t range = item.find("..");
+        if (range != std::string::npos)
+        {
+            for (int step = std::stoi(item.substr(0, range)); step <= std::stoi(item.substr(range + 2)); step++)
+            {
+                steps.push_back(step);
+            }
+        }
+        else if (!item.empty())
+        {
+            steps.push_back(std::stoi(item));
+        }
+        start = end + 1;
+    }
+    return steps;
+}
+
+// a.wav shifted by 1 is written to <directory>/a+1.wav, the same names as in results
+std::string getOutputFilename(const std::string& directory, const std::string& inputFilename, int steps)
+{
+    std::size_t slash = inputFilename.find_last_of("/\\");
+    std::string name = inputFilename.substr(slash == std::string::npos ? 0 : slash + 1);
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0)
+    {
+        name.resize(name.size() - 4);
+    }
+    return directory + "/" + name + (steps >= 0 ? "+" : "") + std::to_string(steps) + ".wav";
+}
+
+// writes a cached render in the format of its input
+void writeRender(const RenderCache::Render& render, const std::string& filename, uint32_t bitsPerSample, bool ieeeFloat)
 {
-    int steps = argc >= 2 ? std::stoi(argv[1]) : 0;
-    std::string inputFilename = argc >= 3 ? argv[2] : "samples/8-bit.wav";
-    std::string outputFilename = argc >= 4 ? argv[3] : "output.wav";
+    std::vector<const double*> channels(render.getNumChannels());
+    for (uint32_t channel = 0; channel < render.getNumChannels(); channel++)
+    {
+        channels[channel] = render.getChannel(channel);
+    }
+    WaveWriter writer(filename, render.getNumChannels(), render.getSampleRate(), bitsPerSample, ieeeFloat, render.getNumSamples());
+    writer.setThreadPool(&ThreadPool::getShared());
+    writer.write(channels.data(), render.getNumSamples());
+    writer.close();
+}
+
+// shifts every input by every step in one process, as (file, step, channel) tasks on the shared pool
+// each file is decoded once for all of its steps, and every task uses the same shifter (and FFT plan),
+// which is only read while shifting
+// the tasks of a file are queued on the worker that decoded it, which works through them newest first
+// while idle workers steal the oldest, and each output is written by the task that shifts its last channel
+// with a cache, outputs that are already cached are written straight from it, and the others are stored in it
+// the output directory is created if needed, and outputs that can't be written are listed at the end
+int runBatch(const std::vector<std::string>& inputFilenames, const std::vector<int>& steps, const std::string& directory,
+    const RenderCache* cache)
+{
+    struct Output
+    {
+        std::shared_ptr<const WaveFile> input;
+        uint32_t bitsPerSample;
+        bool ieeeFloat;
+        std::string filename;
+        int steps;
+        std::string key;
+
+        // allocated by the first channel to start and freed once the file is written,
+        // so only the outputs that are in progress take up memory
+        std::once_flag allocated;
+        SampleBuffer samples;
+        std::atomic<uint32_t> numChannelsLeft;
+    };
+
+    // outputs are named after their inputs, so inputs with the same name would overwrite each other
+    std::map<std::string, std::string> names;
+    for (const std::string& inputFilename : inputFilenames)
+    {
+        std::string outputFilename = getOutputFilename(directory, inputFilename, 0);
+        if (!names.emplace(outputFilename, inputFilename).second)
+        {
+            std::cerr << inputFilename << " and " << names[outputFilename] << " have the same name" << std::endl;
+            return 1;
+        }
+    }
+
+    // if this fails, every output fails to be created and is reported below
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    ThreadPool& pool = ThreadPool::getShared();
+    PitchShifter shifter(FRAME_SIZE, OVERLAP_FACTOR);
+    std::size_t numOutputsLeft = inputFilenames.size() * steps.size();
+    std::vector<std::string> failures;
+    std::mutex mutex;
+    std::condition_variable condition;
+    auto finishOutput = [&]
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--numOutputsLeft == 0)
+            {
+                condition.notify_all();
+            }
+        };
+    auto failOutput = [&](const std::runtime_error& error)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            failures.push_back(error.what());
+        };
 
-    WaveFile file = WaveFile(inputFilename);
-    PitchShifter shifter = PitchShifter(8192, 4);
-    shifter.shift(file, steps);
-    file.write(outputFilename);
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& inputFilename : inputFilenames)
+    {
+        pool.submit([&, inputFilename]
+            {
+                auto decoded = std::make_shared<WaveFile>(inputFilename);
+                std::shared_ptr<const WaveFile> input = decoded;
+                uint64_t audioHash = cache != nullptr ? RenderCache::hashAudio(input->samples, input->sampleRate) : 0;
+                for (int step : steps)
+                {
+                    std::string key;
+                    if (cache != nullptr)
+                    {
+                        key = RenderCache::getKey(audioHash, shifter, step);
+                        std::shared_ptr<const RenderCache::Render> render = cache->load(key);
+                        if (render != nullptr)
+                        {
+                            try
+                            {
+                                writeRender(*render, getOutputFilename(directory, inputFilename, step),
+                                    decoded->getBitsPerSample(), decoded->isIeeeFloat());
+                            }
+                            catch (const std::runtime_error& error)
+                            {
+                                failOutput(error);
+                            }
+                            finishOutput();
+                            continue;
+                        }
+                    }
 
+                    auto output = std::make_shared<Output>();
+                    output->input = input;
+                    output->bitsPerSample = decoded->getBitsPerSample();
+                    output->ieeeFloat = decoded->isIeeeFloat();
+                    output->filename = getOutputFilename(directory, inputFilename, step);
+                    output->steps = step;
+                    output->key = key;
+                    output->numChannelsLeft = input->numChannels;
+                    if (input->numChannels == 0)
+                    {
+                        finishOutput();
+                    }
+                    for (uint32_t channel = 0; channel < input->numChannels; channel++)
+                    {
+                        pool.submit([&, output, channel]
+                            {
+                                const WaveFile& file = *output->input;
+                                std::call_once(output->allocated, [&]
+                                    {
+                                        output->samples = SampleBuffer(file.numChannels, file.numSamples);
+                                    });
+                                shifter.shift(file.samples.getChannel(channel), output->samples.getChannel(channel),
+                                    file.numSamples, output->steps);
+                                if (--output->numChannelsLeft > 0)
+                                {
+                                    return;
+                                }
+
+                                std::vector<const double*> channels(file.numChannels);
+                                for (uint32_t j = 0; j < file.numChannels; j++)
+                                {
+                                    channels[j] = output->samples.getChannel(j);
+                                }
+                                try
+                                {
+                                    WaveWriter writer(output->filename, file.numChannels, file.sampleRate,
+                                        output->bitsPerSample, output->ieeeFloat, file.numSamples);
+                                    writer.write(channels.data(), file.numSamples);
+                                    writer.close();
+                                }
+                                catch (const std::runtime_error& error)
+                                {
+                                    failOutput(error);
+                                }
+                                if (cache != nullptr)
+                                {
+                                    cache->store(output->key, output->samples, file.sampleRate);
+                                }
+                                output->samples = SampleBuffer();
+                                finishOutput();
+                            });
+                    }
+                }
+            });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&] { return numOutputsLeft == 0; });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!failures.empty())
+    {
+        std::sort(failures.begin(), failures.end());
+        for (const std::string& failure : failures)
+        {
+            std::cerr << failure << std::endl;
+        }
+        std::cerr << "Failed to write " << failures.size() << " of " << inputFilenames.size() * steps.size()
+            << " outputs" << std::endl;
+        return 1;
+    }
+    std::cout << "Shifted " << inputFilenames.size() << " files by " << steps.size() << " steps each in "
+        << seconds << " s" << std::endl;
+    return 0;
+}
+
+// stream the file through the shifter so that large (e.g. RF64) files don't have to fit in memory
+// the file is decoded and encoded on their own threads while it is shifted
+// with a cache, the whole file is decoded to hash it, so it is shifted in memory instead
+int runSingle(int steps, const std::string& inputFilename, const std::string& outputFilename, const RenderCache* cache)
+{
+    if (cache != nullptr)
+    {
+        WaveFile file(inputFilename);
+        PitchShifter shifter(FRAME_SIZE, OVERLAP_FACTOR);
+        std::string key = RenderCache::getKey(RenderCache::hashAudio(file.samples, file.sampleRate), shifter, steps);
+        std::shared_ptr<const RenderCache::Render> render = cache->load(key);
+        if (render != nullptr)
+        {
+            writeRender(*render, outputFilename, file.getBitsPerSample(), file.isIeeeFloat());
+            return 0;
+        }
+        shifter.shift(file, steps);
+        cache->store(key, file.samples, file.sampleRate);
+        file.write(outputFilename);
+        return 0;
+    }
+
+    WaveReader input = WaveReader(inputFilename);
+    WaveWriter output = WaveWriter(outputFilename, input.numChannels, input.sampleRate,
+        input.getBitsPerSample(), input.isIeeeFloat(), input.numSamples);
+    input.setThreadPool(&ThreadPool::getShared());
+    output.setThreadPool(&ThreadPool::getShared());
+    PitchShifter shifter = PitchShifter(FRAME_SIZE, OVERLAP_FACTOR);
+    shifter.shiftPipelined(input, output, steps);
+    output.close();
     return 0;
 }
+
+int main(int argc, char** argv)
+{
+    // --trace <file> times each stage of the shift and saves the timeline in Chrome's trace format,
+    // which can be opened in chrome://tracing or https://ui.perfetto.dev
+    // --cache keeps renders in the user's cache directory, which the plugin uses too,
+    // and --cache-dir <directory> keeps them in directory instead
+    std::string traceFilename;
+    std::unique_ptr<RenderCache> cache;
+    while (argc >= 2)
+    {
+        std::string option = argv[1];
+        if (option == "--trace" && argc >= 3)
+        {
+            traceFilename = argv[2];
+            argv += 2;
+            argc -= 2;
+            Profiler::setEnabled(true);
+        }
+        else if (option == "--cache")
+        {
+            cache = std::make_unique<RenderCache>(RenderCache::getDefaultDirectory());
+            argv += 1;
+            argc -= 1;
+        }
+        else if (option == "--cache-dir" && argc >= 3)
+        {
+            cache = std::make_unique<RenderCache>(argv[2]);
+            argv += 2;
+            argc -= 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    int result;
+    if (argc >= 4 && std::string(argv[1]) == "--batch")
+    {
+        // --batch <output directory> <steps> [--manifest <file>] [input wav ...]
+        // shifts every input (from the manifest, one per line, and the arguments) by every step
+        std::vector<std::string> inputFilenames;
+        for (int i = 4; i < argc; i++)
+        {
+            std::string argument = argv[i];
+            if (argument == "--manifest" && i + 1 < argc)
+            {
+                std::ifstream manifest(argv[++i]);
+                std::string line;
+                while (std::getline(manifest, line))
+                {
+                    if (!line.empty() && line[0] != '#')
+                    {
+                        inputFilenames.push_back(line);
+                    }
+                }
+            }
+            else
+            {
+                inputFilenames.push_back(argument);
+            }
+        }
+        result = runBatch(inputFilenames, parseSteps(argv[3]), argv[2], cache.get());
+    }
+    else
+    {
+        int steps = argc >= 2 ? std::stoi(argv[1]) : 0;
+        std::string inputFilename = argc >= 3 ? argv[2] : "samples/8-bit.wav";
+        std::string outputFilename = argc >= 4 ? argv[3] : "output.wav";
+        try
+        {
+            result = runSingle(steps, inputFilename, outputFilename, cache.get());
+        }
+        catch (const std::runtime_error& error)
+        {
+            std::cerr << error.what() << std::endl;
+            result = 1;
+        }
+    }
+
+    if (!traceFilename.empty())
+    {
+        Profiler::setEnabled(false);
+        Profiler::writeChromeTrace(traceFilename);
+        Profiler::writeSummary(std::cout);
+    }
+
+    return result;
+}
@@ -5,10 +5,16 @@
 # saving the results into the results directory
 
 echo "Compiling ..."
-g++ results.cpp \
+g++ demo.cpp \
     ../Source/FourierTransformer.cpp \
     ../Source/PitchShifter.cpp \
-    ../Source/WaveFile.cpp -o windigo
+    ../Source/Profiler.cpp \
+    ../Source/RenderCache.cpp \
+    ../Source/SampleBuffer.cpp \
+    ../Source/ThreadPool.cpp \
+    ../Source/WaveFile.cpp \
+    ../Source/WaveReader.cpp \
+    ../Source/WaveWriter.cpp -o windigo
 
 echo "Processing 8-bit files ..."
 mkdir -p ./demo/8-bit
@@ -0,0 +1,76 @@
+#include "CompressedSamples.h"
+
+#include <algorithm>
+#include <cmath>
+
+CompressedSamples::CompressedSamples(const juce::AudioBuffer<float>& samples, int numSamples)
+    : numChannels(samples.getNumChannels()), numSamples(numSamples)
+{
+    int numBlocks = (numSamples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    codes = std::vector<std::vector<int16_t>>(numChannels, std::vector<int16_t>(numSamples));
+    scales = std::vector<std::vector<float>>(numChannels, std::vector<float>(numBlocks));
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        const float* in = samples.getReadPointer(channel);
+        for (int block = 0; block < numBlocks; block++)
+        {
+            int start = block * BLOCK_SIZE;
+            int end = std::min(start + BLOCK_SIZE, numSamples);
+
+            // the loudest sample of the block is coded as +-32767
+            float peak = 0.0f;
+            for (int i = start; i < end; i++)
+            {
+                peak = std::max(peak, std::abs(in[i]));
+            }
+            float scale = peak / 32767.0f;
+            scales[channel][block] = scale;
+            if (scale == 0.0f)
+            {
+                continue;
+            }
+
+            for (int i = start; i < end; i++)
+            {
+                float code = std::round(in[i] / scale);
+                codes[channel][i] = (int16_t) std::clamp(code, -32767.0f, 32767.0f);
+            }
+        }
+    }
+}
+
+void CompressedSamples::decode(int channel, int start, int numSamples, float* destination) const
+{
+    const int16_t* in = codes[channel].data();
+    const float* channelScales = scales[channel].data();
+    int end = std::min(start + numSamples, this->numSamples);
+
+    // the scale only changes between blocks, so the inner loop is a plain multiply
+    int i = start;
+    while (i < end)
+    {
+        int blockEnd = std::min((i / BLOCK_SIZE + 1) * BLOCK_SIZE, end);
+        float scale = channelScales[i / BLOCK_SIZE];
+        for (; i < blockEnd; i++)
+        {
+            *destination++ = in[i] * scale;
+        }
+    }
+    std::fill(destination, destination + (start + numSamples - i), 0.0f);
+}
+
+int CompressedSamples::getNumChannels() const
+{
+    return numChannels;
+}
+
+int CompressedSamples::getNumSamples() const
+{
+    return numSamples;
+}
+
+std::size_t CompressedSamples::getSizeInBytes() const
+{
+    int numBlocks = (numSamples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    return (std::size_t) numChannels * (numSamples * sizeof(int16_t) + numBlocks * sizeof(float));
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <cstdint>
+#include <vector>
+
+//==============================================================================
+/**
+    Float samples stored as 16-bit integers, at half the size of the floats.
+
+    Each block of each channel has its own scale, so quiet passages keep their
+    resolution. Decoding is one multiply per sample, cheap enough to run on the
+    audio thread for every block that is played.
+*/
+class CompressedSamples
+{
+public:
+  static const int BLOCK_SIZE = 256;
+
+  // not real-time safe, encodes the first numSamples samples of every channel
+  CompressedSamples(const juce::AudioBuffer<float>& samples, int numSamples);
+
+  // real-time safe, decodes numSamples samples of a channel starting from start
+  // samples past the end decode as zero
+  void decode(int channel, int start, int numSamples, float* destination) const;
+
+  int getNumChannels() const;
+  int getNumSamples() const;
+  std::size_t getSizeInBytes() const;
+
+private:
+  int numChannels;
+  int numSamples;
+  std::vector<std::vector<int16_t>> codes;
+
+  // the value of one step of the codes in each block
+  std::vector<std::vector<float>> scales;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressedSamples)
+};
\ No newline at end of file
@@ -1,135 +1,189 @@
 #include "FourierTransformer.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <complex>
 #include <vector>
 
-std::vector<std::complex<double>> FourierTransformer::fft(std::vector<std::complex<double>> input, uint32_t numSamples)
+FourierTransformer::FourierTransformer(uint32_t numSamples)
+    : plannedSize(0)
 {
-    // zero pad input so that its length is a power of 2
-    int log2n = padInput(input, numSamples);
-    numSamples = 1 << log2n;
+    if (numSamples < 2 || (numSamples & (numSamples - 1)) != 0)
+    {
+        return;
+    }
 
-    std::vector<std::complex<double>> output(numSamples); // a
-    std::vector<std::complex<double>> buffer(numSamples); // A
-    for (int i = 0; i < numSamples; i++)
+    uint8_t log2n = log2Size(numSamples);
+    plannedBits = std::vector<uint32_t>(numSamples);
+    for (uint32_t i = 0; i < numSamples; i++)
     {
-        output[reverseBits(i, log2n)] = input[i];
+        plannedBits[i] = reverseBits(i, log2n);
     }
 
-    // using butterfly computations
-    // refer to page 6 of https://www.cs.cmu.edu/afs/andrew/scs/cs/15-463/2001/pub/www/notes/fourier/fourier.pdf
-    // W = e^(-i * (2π / N))
+    // the twiddle factors are found by running the butterflies without any data,
+    // so they are computed exactly as they would be without a plan
+    forwardTwiddles = std::vector<std::complex<double>>((std::size_t) numSamples * log2n);
+    inverseTwiddles = std::vector<std::complex<double>>((std::size_t) numSamples * log2n);
     std::complex<double> w = exp(-I * (M_PI / (numSamples >> 1)));
+    std::size_t t = 0;
     for (int i = 0; i < log2n; i++)
     {
         int offset = 1 << i;
-
-        // group together computations
-        // groups of size 2, 4, 8, ...
         int numGroups = 1 << (log2n - 1 - i);
         int groupSize = 1 << (i + 1);
         for (int j = 0; j < numGroups; j++)
         {
-            // for downward pointing arrows (i.e. p)
-            for (int k = 0; k < offset; k++)
-            {
-                int index = j * groupSize + k;
-                buffer[index] += output[index]; // p
-                buffer[index + offset] += output[index]; // p
-            }
-
-            // for upward pointing arrows (i.e. q)
             for (int k = 0; k < offset; k++)
             {
                 int index = j * groupSize + k + offset;
-
-                // at stage i of computation,
-                // the coefficients of q, alpha = w^x,
-                // where x follows the arithmetic progression
-                // with common difference N / 2^(i + 1) modulo N
-                //
-                // e.g. at stage i = 0 for an input of size N = 8,
-                // the sequence will be 0, 4, 8, 12, ...
-                // the sequence modulo 8 is 0, 4, 0, 4, ...
                 int commonDifference = numGroups;
-
-                // upward arrow
-                int upExponent = modulo((index - offset) * commonDifference, numSamples);
-                std::complex<double> upAlpha = pow(w, upExponent);
-                buffer[index - offset] += upAlpha * output[index];
-
-                // horizontal arrow
-                int downExponent = modulo(index * commonDifference, numSamples);
-                std::complex<double> downAlpha = pow(w, downExponent);
-                buffer[index] += downAlpha * output[index];
+                uint32_t upExponent = modulo((index - offset) * commonDifference, numSamples);
+                uint32_t downExponent = modulo(index * commonDifference, numSamples);
+                forwardTwiddles[t] = twiddle(w, upExponent);
+                forwardTwiddles[t + 1] = twiddle(w, downExponent);
+                inverseTwiddles[t] = twiddle(w, -upExponent);
+                inverseTwiddles[t + 1] = twiddle(w, -downExponent);
+                t += 2;
             }
         }
-
-        output.swap(buffer);
-        std::fill(buffer.begin(), buffer.end(), 0.0);
     }
+    plannedSize = numSamples;
+}
 
+std::vector<std::complex<double>> FourierTransformer::fft(std::vector<std::complex<double>> input, uint32_t numSamples)
+{
+    // zero pad input so that its length is a power of 2
+    int log2n = padInput(input, numSamples);
+    numSamples = 1 << log2n;
+
+    std::vector<std::complex<double>> output(numSamples); // a
+    std::vector<std::complex<double>> buffer(numSamples); // A
+    transform(input.data(), output.data(), buffer.data(), log2n, false,
+        numSamples == plannedSize ? forwardTwiddles.data() : nullptr);
     return output;
 }
 
 std::vector<std::complex<double>> FourierTransformer::ifft(std::vector<std::complex<double>> input, uint32_t numSamples)
 {
-    // the implementation is identical to FFT,
-    // except coefficients are negated and there is a division by N at the end
     int log2n = padInput(input, numSamples);
     numSamples = 1 << log2n;
 
     std::vector<std::complex<double>> output(numSamples); // A
     std::vector<std::complex<double>> buffer(numSamples); // a
-    for (int i = 0; i < numSamples; i++)
+    transform(input.data(), output.data(), buffer.data(), log2n, true,
+        numSamples == plannedSize ? inverseTwiddles.data() : nullptr);
+    return output;
+}
+
+void FourierTransformer::fft(const std::complex<double>* input, std::complex<double>* output, std::complex<double>* buffer, uint32_t numSamples)
+{
+    int log2n = log2Size(numSamples);
+    transform(input, output, buffer, log2n, false, numSamples == plannedSize ? forwardTwiddles.data() : nullptr);
+}
+
+void FourierTransformer::ifft(const std::complex<double>* input, std::complex<double>* output, std::complex<double>* buffer, uint32_t numSamples)
+{
+    int log2n = log2Size(numSamples);
+    transform(input, output, buffer, log2n, true, numSamples == plannedSize ? inverseTwiddles.data() : nullptr);
+}
+
+void FourierTransformer::transform(const std::complex<double>* input, std::complex<double>* output, std::complex<double>* buffer,
+    uint8_t log2n, bool inverse, const std::complex<double>* twiddles)
+{
+    uint32_t numSamples = 1 << log2n;
+    for (uint32_t i = 0; i < numSamples; i++)
     {
-        output[reverseBits(i, log2n)] = input[i];
+        output[twiddles != nullptr ? plannedBits[i] : reverseBits(i, log2n)] = input[i];
     }
+    std::fill(buffer, buffer + numSamples, 0.0);
 
+    // using butterfly computations
+    // refer to page 6 of https://www.cs.cmu.edu/afs/andrew/scs/cs/15-463/2001/pub/www/notes/fourier/fourier.pdf
+    // W = e^(-i * (2π / N))
+    //
+    // the inverse transform is identical,
+    // except coefficients are negated and there is a division by N at the end
     std::complex<double> w = exp(-I * (M_PI / (numSamples >> 1)));
+    std::complex<double>* a = output;
+    std::complex<double>* b = buffer;
     for (int i = 0; i < log2n; i++)
     {
         int offset = 1 << i;
+
+        // group together computations
+        // groups of size 2, 4, 8, ...
         int numGroups = 1 << (log2n - 1 - i);
         int groupSize = 1 << (i + 1);
         for (int j = 0; j < numGroups; j++)
         {
+            // for downward pointing arrows (i.e. p)
             for (int k = 0; k < offset; k++)
             {
                 int index = j * groupSize + k;
-                buffer[index] += output[index];
-                buffer[index + offset] += output[index];
+                b[index] += a[index]; // p
+                b[index + offset] += a[index]; // p
             }
 
+            // for upward pointing arrows (i.e. q)
             for (int k = 0; k < offset; k++)
             {
                 int index = j * groupSize + k + offset;
-                int commonDifference = numGroups;
+                std::complex<double> upAlpha;
+                std::complex<double> downAlpha;
+                if (twiddles != nullptr)
+                {
+                    upAlpha = twiddles[0];
+                    downAlpha = twiddles[1];
+                    twiddles += 2;
+                }
+                else
+                {
+                    // at stage i of computation,
+                    // the coefficients of q, alpha = w^x,
+                    // where x follows the arithmetic progression
+                    // with common difference N / 2^(i + 1) modulo N
+                    //
+                    // e.g. at stage i = 0 for an input of size N = 8,
+                    // the sequence will be 0, 4, 8, 12, ...
+                    // the sequence modulo 8 is 0, 4, 0, 4, ...
+                    int commonDifference = numGroups;
+                    uint32_t upExponent = modulo((index - offset) * commonDifference, numSamples);
+                    uint32_t downExponent = modulo(index * commonDifference, numSamples);
+                    upAlpha = twiddle(w, inverse ? -upExponent : upExponent);
+                    downAlpha = twiddle(w, inverse ? -downExponent : downExponent);
+                }
 
-                // negate exponent
-                int upExponent = -modulo((index - offset) * commonDifference, numSamples);
-                std::complex<double> upAlpha = pow(w, upExponent);
-                buffer[index - offset] += upAlpha * output[index];
+                // upward arrow
+                b[index - offset] += upAlpha * a[index];
 
-                // negate exponent
-                int downExponent = -modulo(index * commonDifference, numSamples);
-                std::complex<double> downAlpha = pow(w, downExponent);
-                buffer[index] += downAlpha * output[index];
+                // horizontal arrow
+                b[index] += downAlpha * a[index];
             }
         }
 
-        output.swap(buffer);
-        std::fill(buffer.begin(), buffer.end(), 0.0);
+        std::swap(a, b);
+        std::fill(b, b + numSamples, 0.0);
     }
 
-    // division by N
-    for (int i = 0; i < numSamples; i++)
+    // the result is in whichever array the last stage wrote to
+    if (a != output)
     {
-        output[i] /= numSamples;
+        std::copy(a, a + numSamples, output);
     }
 
-    return output;
+    if (inverse)
+    {
+        // division by N
+        for (uint32_t i = 0; i < numSamples; i++)
+        {
+            output[i] /= numSamples;
+        }
+    }
+}
+
+std::complex<double> FourierTransformer::twiddle(std::complex<double> w, int exponent)
+{
+    return pow(w, exponent);
 }
 
 uint8_t FourierTransformer::padInput(std::vector<std::complex<double>>& input, uint32_t numSamples)
@@ -148,6 +202,17 @@ uint8_t FourierTransformer::padInput(std::vector<std::complex<double>>& input, u
     return log2n;
 }
 
+uint8_t FourierTransformer::log2Size(uint32_t numSamples)
+{
+    // the sizes given to the transforms without padding are already powers of 2
+    uint8_t log2n = 0;
+    while ((1u << log2n) < numSamples)
+    {
+        log2n++;
+    }
+    return log2n;
+}
+
 uint32_t FourierTransformer::reverseBits(uint32_t num, uint8_t log2n)
 {
     // TODO: add unit test
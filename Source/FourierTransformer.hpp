@@ -12,11 +12,34 @@ constexpr std::complex<double> I(0, 1);
 class FourierTransformer
 {
 public:
+    // precomputes the bit reversal and twiddle factors for transforms of numSamples (a power of 2)
+    // transforms of other sizes still work, but compute the twiddle factors as they go
+    // the results are identical either way
+    FourierTransformer(uint32_t numSamples = 0);
+
     std::vector<std::complex<double>> fft(std::vector<std::complex<double>> input, uint32_t numSamples);
     std::vector<std::complex<double>> ifft(std::vector<std::complex<double>> input, uint32_t numSamples);
 
+    // same transforms without allocating, so they can be used on the audio thread
+    // numSamples must be a power of 2 and buffer is scratch space of the same size
+    // output and buffer must not overlap input
+    void fft(const std::complex<double>* input, std::complex<double>* output, std::complex<double>* buffer, uint32_t numSamples);
+    void ifft(const std::complex<double>* input, std::complex<double>* output, std::complex<double>* buffer, uint32_t numSamples);
+
 private:
+    // twiddle factors in the order the butterflies use them, 2 per butterfly (up and horizontal arrow)
+    // N / 2 butterflies per stage, so N * log2(N) per direction
+    uint32_t plannedSize;
+    std::vector<uint32_t> plannedBits;
+    std::vector<std::complex<double>> forwardTwiddles;
+    std::vector<std::complex<double>> inverseTwiddles;
+
+    void transform(const std::complex<double>* input, std::complex<double>* output, std::complex<double>* buffer,
+        uint8_t log2n, bool inverse, const std::complex<double>* twiddles);
+    std::complex<double> twiddle(std::complex<double> w, int exponent);
+
     uint8_t padInput(std::vector<std::complex<double>>& input, uint32_t numSamples);
+    uint8_t log2Size(uint32_t numSamples);
     uint32_t reverseBits(uint32_t num, uint8_t log2n);
     uint32_t modulo(uint32_t num, uint8_t modulus);
 };
@@ -0,0 +1,97 @@
+#include "LiveShifter.h"
+
+#include <algorithm>
+
+void LiveShifter::prepare(int numChannels, int maxBlockSize, int frameSize, int steps)
+{
+    this->maxBlockSize = std::max(1, maxBlockSize);
+    shifter = std::make_unique<PitchShifter>(frameSize, OVERLAP_FACTOR);
+
+    // the streams never have an end, which keeps their phases bounded
+    streams.clear();
+    streams.reserve(numChannels);
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        streams.emplace_back(*shifter, steps, 0, (std::size_t) this->maxBlockSize);
+    }
+    input = std::vector<double>(this->maxBlockSize);
+
+    // the output of a stream is at most a frame behind its input (the analysis padding
+    // is a frame minus a hop, and the last hop of input is waiting for its frame to fill)
+    // so a frame of silence in front of it means there is always a block to play
+    latency = frameSize;
+    std::size_t fifoSize = 1;
+    while (fifoSize < (std::size_t) latency + this->maxBlockSize + 1)
+    {
+        fifoSize <<= 1;
+    }
+    fifos = std::vector<std::vector<double>>(numChannels, std::vector<double>(fifoSize));
+    fifoMask = fifoSize - 1;
+    fifoStarts = std::vector<uint64_t>(numChannels, 0);
+    fifoEnds = std::vector<uint64_t>(numChannels, latency);
+}
+
+void LiveShifter::reset()
+{
+    shifter.reset();
+    streams.clear();
+    fifos.clear();
+}
+
+int LiveShifter::getLatencySamples() const
+{
+    return latency;
+}
+
+void LiveShifter::process(juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    numChannels = std::min(numChannels, (int) streams.size());
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        // the host can send blocks bigger than it said it would
+        float* samples = buffer.getWritePointer(channel);
+        for (int start = 0; start < buffer.getNumSamples(); start += maxBlockSize)
+        {
+            processChannel(samples + start, std::min(maxBlockSize, buffer.getNumSamples() - start), channel);
+        }
+    }
+}
+
+void LiveShifter::processChannel(float* samples, int numSamples, int channel)
+{
+    PitchShifter::Stream& stream = streams[channel];
+    std::vector<double>& fifo = fifos[channel];
+    uint64_t& fifoStart = fifoStarts[channel];
+    uint64_t& fifoEnd = fifoEnds[channel];
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        input[i] = samples[i];
+    }
+    stream.push(input.data(), numSamples);
+
+    // pull everything that is ready, since the stream needs room before the next push
+    // the ring buffer wraps, so it is filled in at most 2 contiguous parts
+    while (true)
+    {
+        uint64_t space = fifo.size() - (fifoEnd - fifoStart);
+        uint64_t contiguous = std::min<uint64_t>(space, fifo.size() - (fifoEnd & fifoMask));
+        if (contiguous == 0)
+        {
+            break;
+        }
+
+        std::size_t pulled = stream.pull(&fifo[fifoEnd & fifoMask], (std::size_t) contiguous);
+        fifoEnd += pulled;
+        if (pulled == 0)
+        {
+            break;
+        }
+    }
+
+    // the delay means there is always enough, but play silence rather than stale samples if not
+    for (int i = 0; i < numSamples; i++)
+    {
+        samples[i] = fifoStart < fifoEnd ? (float) fifo[fifoStart++ & fifoMask] : 0.0f;
+    }
+}
\ No newline at end of file
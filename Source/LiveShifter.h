@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <memory>
+#include <vector>
+
+#include "PitchShifter.hpp"
+
+//==============================================================================
+/**
+    Shifts live input block by block, as an insert effect.
+
+    Everything is allocated in prepare, so process can run on the audio thread.
+    The shifted output lags the input by up to a frame, so it is delayed by exactly
+    one frame to keep the latency constant for the host to compensate.
+*/
+class LiveShifter
+{
+public:
+  static const int DEFAULT_FRAME_SIZE = 1024;
+  static const int OVERLAP_FACTOR = 4;
+
+  // not real-time safe
+  void prepare(int numChannels, int maxBlockSize, int frameSize, int steps);
+  void reset();
+
+  int getLatencySamples() const;
+
+  // real-time safe, shifts the first numChannels channels of the buffer in place
+  void process(juce::AudioBuffer<float>& buffer, int numChannels);
+
+private:
+  std::unique_ptr<PitchShifter> shifter;
+  std::vector<PitchShifter::Stream> streams;
+  int maxBlockSize = 0;
+  int latency = 0;
+
+  // input converted to double before it is pushed
+  std::vector<double> input;
+
+  // shifted output waiting to be played, one ring buffer per channel
+  std::vector<std::vector<double>> fifos;
+  std::vector<uint64_t> fifoStarts;
+  std::vector<uint64_t> fifoEnds;
+  uint64_t fifoMask = 0;
+
+  void processChannel(float* samples, int numSamples, int channel);
+};
\ No newline at end of file
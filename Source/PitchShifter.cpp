@@ -1,19 +1,59 @@
 #include "FourierTransformer.hpp"
 #include "PitchShifter.hpp"
+#include "Profiler.hpp"
+#include "SpscQueue.hpp"
 #include "WaveFile.hpp"
+#include "WaveReader.hpp"
+#include "WaveWriter.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <complex>
+#include <cstring>
+#include <thread>
 #include <vector>
 
 PitchShifter::PitchShifter(int frameSize, int overlapFactor)
+    : transformer(frameSize)
 {
     // recommended 75% overlap
     this->frameSize = frameSize;
     this->overlapFactor = overlapFactor;
+
+    // necessary for smoothing
+    window = hanningWindow(frameSize);
+    omegas = std::vector<double>(frameSize);
+    for (int k = 0; k < frameSize; k++)
+    {
+        omegas[k] = 2 * M_PI * k / frameSize;
+    }
+}
+
+int PitchShifter::getFrameSize() const
+{
+    return frameSize;
+}
+
+int PitchShifter::getOverlapFactor() const
+{
+    return overlapFactor;
 }
 
 void PitchShifter::shift(WaveFile& file, int steps)
+{
+    shift(file, steps, nullptr);
+}
+
+bool PitchShifter::shift(WaveFile& file, int steps, const std::function<bool(double)>& onProgress)
+{
+    return shiftProgressively(file, steps, [&](uint64_t numSamplesShifted)
+        {
+            return !onProgress || onProgress((double) numSamplesShifted / file.numSamples);
+        });
+}
+
+bool PitchShifter::shiftProgressively(WaveFile& file, int steps, const std::function<bool(uint64_t)>& onShifted)
 {
     // phase vocoder algorithm
     // the phase vocoder algorithm uses the short-time Fourier transform to
@@ -29,132 +69,526 @@ void PitchShifter::shift(WaveFile& file, int steps)
     // https://www-fourier.ujf-grenoble.fr/~faure/enseignement/musique/documents/chapter_4_musical_theories/2007_Sethares-Rhythm%20and%20Transforms.pdf
     // https://github.com/cwoodall/pitch-shifter-py
     // http://blogs.zynaptiq.com/bernsee/pitch-shifting-using-the-ft/
+    //
+    // the work is done by one Stream per channel, one block at a time
+    // the output is always behind the input, so each channel can be shifted in place
+    //
+    // output is pulled one hop at a time (roughly one frame of work) from each channel in turn,
+    // so that onShifted can follow the shifted prefix and cancel the shift between frames
+    PROFILE_SCOPE("shift");
+    std::size_t blockSize = BLOCK_SIZE;
+    std::size_t hopSize = std::max(1, frameSize / overlapFactor);
+    std::vector<Stream> streams;
+    streams.reserve(file.numChannels);
+    for (uint32_t channel = 0; channel < file.numChannels; channel++)
+    {
+        streams.emplace_back(*this, steps, file.numSamples, blockSize);
+    }
+
+    uint64_t numSamplesPushed = 0;
+    uint64_t numSamplesPulled = 0;
+    while (numSamplesPulled < file.numSamples)
+    {
+        std::size_t count = (std::size_t) std::min<uint64_t>(blockSize, file.numSamples - numSamplesPushed);
+        for (uint32_t channel = 0; channel < file.numChannels; channel++)
+        {
+            if (count > 0)
+            {
+                streams[channel].push(&file.samples.getChannel(channel)[numSamplesPushed], count);
+            }
+            else
+            {
+                streams[channel].finish();
+            }
+        }
+        numSamplesPushed += count;
+
+        // every channel has the same length, so the same number of samples is ready in each
+        std::size_t pulled;
+        do
+        {
+            pulled = 0;
+            std::size_t hop = (std::size_t) std::min<uint64_t>(hopSize, file.numSamples - numSamplesPulled);
+            for (uint32_t channel = 0; channel < file.numChannels; channel++)
+            {
+                pulled = streams[channel].pull(&file.samples.getChannel(channel)[numSamplesPulled], hop);
+            }
+            numSamplesPulled += pulled;
+            Profiler::count("samples shifted", pulled);
+            if (pulled > 0 && !onShifted(numSamplesPulled))
+            {
+                return false;
+            }
+        } while (pulled > 0);
+    }
+    return true;
+}
+
+void PitchShifter::shift(WaveReader& input, WaveWriter& output, int steps)
+{
+    shift(input, output, steps, nullptr);
+}
+
+bool PitchShifter::shift(WaveReader& input, WaveWriter& output, int steps, const std::function<bool(double)>& onProgress)
+{
+    // same as shifting a WaveFile, except that only one block of each channel is kept in memory
+    // so files which are larger than memory (e.g. RF64) can be shifted
+    PROFILE_SCOPE("shift");
+    uint32_t numChannels = input.numChannels;
+    std::size_t blockSize = BLOCK_SIZE;
+    std::vector<Stream> streams;
+    streams.reserve(numChannels);
+    for (uint32_t channel = 0; channel < numChannels; channel++)
+    {
+        streams.emplace_back(*this, steps, input.numSamples, blockSize);
+    }
+
+    SampleBuffer inputBlock(numChannels, blockSize);
+    SampleBuffer outputBlock(numChannels, blockSize);
+    std::vector<double*> inputChannels(numChannels);
+    std::vector<double*> outputChannels(numChannels);
+    for (uint32_t channel = 0; channel < numChannels; channel++)
+    {
+        inputChannels[channel] = inputBlock.getChannel(channel);
+        outputChannels[channel] = outputBlock.getChannel(channel);
+    }
+
+    input.seek(0);
+    uint64_t numSamplesPulled = 0;
+    while (numSamplesPulled < input.numSamples)
+    {
+        uint64_t count = input.read(inputChannels.data(), blockSize);
+        for (uint32_t channel = 0; channel < numChannels; channel++)
+        {
+            if (count > 0)
+            {
+                streams[channel].push(inputChannels[channel], count);
+            }
+            else
+            {
+                streams[channel].finish();
+            }
+        }
+
+        // every channel has the same length, so the same number of samples is ready in each
+        std::size_t pulled;
+        do
+        {
+            pulled = 0;
+            for (uint32_t channel = 0; channel < numChannels; channel++)
+            {
+                pulled = streams[channel].pull(outputChannels[channel], blockSize);
+            }
+            output.write(outputChannels.data(), pulled);
+            numSamplesPulled += pulled;
+            Profiler::count("samples shifted", pulled);
+        } while (pulled > 0);
+
+        if (onProgress && !onProgress((double) numSamplesPulled / std::max<uint64_t>(1, input.numSamples)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PitchShifter::shiftPipelined(WaveReader& input, WaveWriter& output, int steps)
+{
+    // the same loop as the sequential shift, with the reads and writes moved to their own threads
+    // each direction has a queue of full blocks and a queue that returns the empty ones,
+    // so nothing is allocated once the pipeline is running
+    PROFILE_SCOPE("shift");
+    struct Block
+    {
+        SampleBuffer samples;
+        uint64_t count;
+        std::vector<double*> channels;
+    };
+
+    uint32_t numChannels = input.numChannels;
+    std::size_t blockSize = BLOCK_SIZE;
+    std::vector<Block> blocks(2 * PIPELINE_DEPTH);
+    SpscQueue<Block*> decoded(PIPELINE_DEPTH);
+    SpscQueue<Block*> emptyInput(PIPELINE_DEPTH);
+    SpscQueue<Block*> shifted(PIPELINE_DEPTH);
+    SpscQueue<Block*> emptyOutput(PIPELINE_DEPTH);
+    for (std::size_t i = 0; i < blocks.size(); i++)
+    {
+        Block& block = blocks[i];
+        block.samples = SampleBuffer(numChannels, blockSize);
+        block.count = 0;
+        for (uint32_t channel = 0; channel < numChannels; channel++)
+        {
+            block.channels.push_back(block.samples.getChannel(channel));
+        }
+        (i < PIPELINE_DEPTH ? emptyInput : emptyOutput).push(&block);
+    }
+
+    // a block with no samples marks the end of each stage's output
+    std::thread decoder([&]
+        {
+            input.seek(0);
+            uint64_t count;
+            do
+            {
+                Block* block = emptyInput.popWaiting();
+                block->count = count = input.read(block->channels.data(), blockSize);
+                decoded.pushWaiting(block);
+            } while (count > 0);
+        });
+    std::thread encoder([&]
+        {
+            Block* block;
+            while ((block = shifted.popWaiting())->count > 0)
+            {
+                output.write(block->channels.data(), block->count);
+                emptyOutput.pushWaiting(block);
+            }
+        });
+
+    std::vector<Stream> streams;
+    streams.reserve(numChannels);
+    for (uint32_t channel = 0; channel < numChannels; channel++)
+    {
+        streams.emplace_back(*this, steps, input.numSamples, blockSize);
+    }
+
+    uint64_t numSamplesPulled = 0;
+    bool decodedAll = false;
+    Block* outputBlock = emptyOutput.popWaiting();
+    while (numSamplesPulled < input.numSamples)
+    {
+        Block* inputBlock = decoded.popWaiting();
+        decodedAll = inputBlock->count == 0;
+        for (uint32_t channel = 0; channel < numChannels; channel++)
+        {
+            if (!decodedAll)
+            {
+                streams[channel].push(inputBlock->channels[channel], inputBlock->count);
+            }
+            else
+            {
+                streams[channel].finish();
+            }
+        }
+        emptyInput.pushWaiting(inputBlock);
+
+        // every channel has the same length, so the same number of samples is ready in each
+        std::size_t pulled;
+        do
+        {
+            pulled = 0;
+            for (uint32_t channel = 0; channel < numChannels; channel++)
+            {
+                pulled = streams[channel].pull(outputBlock->channels[channel], blockSize);
+            }
+            if (pulled > 0)
+            {
+                numSamplesPulled += pulled;
+                Profiler::count("samples shifted", pulled);
+                outputBlock->count = pulled;
+                shifted.pushWaiting(outputBlock);
+                outputBlock = emptyOutput.popWaiting();
+            }
+        } while (pulled > 0);
+    }
+
+    // the decoder always finishes with an empty block, even if the shift did not need it
+    while (!decodedAll)
+    {
+        Block* inputBlock = decoded.popWaiting();
+        decodedAll = inputBlock->count == 0;
+        emptyInput.pushWaiting(inputBlock);
+    }
+    outputBlock->count = 0;
+    shifted.pushWaiting(outputBlock);
+    decoder.join();
+    encoder.join();
+}
+
+void PitchShifter::shift(const double* input, double* output, uint64_t numSamples, int steps)
+{
+    PROFILE_SCOPE("shift channel");
+    std::size_t blockSize = BLOCK_SIZE;
+    Stream stream(*this, steps, numSamples, blockSize);
+    uint64_t numSamplesPushed = 0;
+    uint64_t numSamplesPulled = 0;
+    while (numSamplesPulled < numSamples)
+    {
+        std::size_t count = (std::size_t) std::min<uint64_t>(blockSize, numSamples - numSamplesPushed);
+        if (count > 0)
+        {
+            stream.push(&input[numSamplesPushed], count);
+        }
+        else
+        {
+            stream.finish();
+        }
+        numSamplesPushed += count;
+
+        // the output is always behind the input, so it can overwrite input that has already been pushed
+        std::size_t pulled;
+        do
+        {
+            pulled = stream.pull(&output[numSamplesPulled], (std::size_t) (numSamples - numSamplesPulled));
+            numSamplesPulled += pulled;
+        } while (pulled > 0);
+    }
+    Profiler::count("samples shifted", numSamples);
+}
+
+PitchShifter::Stream::Stream(PitchShifter& shifter, int steps, uint64_t numSamples, std::size_t maxBlockSize)
+    : shifter(shifter), numSamples(numSamples), finished(false)
+{
+    int frameSize = shifter.frameSize;
+    int overlapFactor = shifter.overlapFactor;
 
     // doubling a frequency results in the pitch jumping an octave
     // i.e. A4 = 440 Hz and A5 = 880 Hz
     // there are 12 semitones in 1 octave, so the corresponding shift would be 2^(semitones / 12)
     double scale = pow(2.0, (double) steps / 12.0);
 
-    int analysisHopSize = frameSize / overlapFactor;
-    int synthesisHopSize = analysisHopSize * scale;
+    analysisHopSize = frameSize / overlapFactor;
+    synthesisHopSize = analysisHopSize * scale;
+    windowNormalisation = std::sqrt(((double) frameSize / analysisHopSize) / 2.0);
 
-    // necessary for smoothing
-    std::vector<double> window = hanningWindow(frameSize);
-    std::vector<double> omegas(frameSize);
-    for (int k = 0; k < frameSize; k++)
-    {
-        omegas[k] = 2 * M_PI * k / frameSize;
-    }
+    // zero pad both ends of input
+    // so that overlap addition of the first and last few frames works properly
+    analysisPadSize = analysisHopSize * (overlapFactor - 1);
+    synthesisPadSize = synthesisHopSize * (overlapFactor - 1);
 
-    for (int channel = 0; channel < file.numChannels; channel++)
+    numFrames = 0;
+    outputSize = 0;
+    unpaddedOutputSize = 0;
+    if (numSamples > 0)
     {
-        // zero pad both ends of input
-        // so that overlap addition of the first and last few frames works properly
-        int analysisPadSize = analysisHopSize * (overlapFactor - 1);
-        int inputSize = file.numSamples + 2 * analysisPadSize;
+        uint64_t inputSize = numSamples + 2 * analysisPadSize;
 
         // pad input so that frames will line up nicely
-        int endFramePad = inputSize - (int) (inputSize / analysisHopSize) * analysisHopSize;
+        uint64_t endFramePad = inputSize - (inputSize / analysisHopSize) * analysisHopSize;
         inputSize += endFramePad;
-        std::vector<std::complex<double>> input(inputSize);
-        for (int k = 0; k < file.numSamples; k++)
-        {
-            input[analysisPadSize + k] = std::complex<double>(file.samples[channel][k]);
-        }
 
         // output size is scaled according to input size since it stores the same audio
         // the pitch shift can then be achieved by resampling
-        int numFrames = inputSize / analysisHopSize - (overlapFactor - 1);
-        int outputSize = inputSize * scale;
-        std::vector<double> output(outputSize);
+        numFrames = inputSize / analysisHopSize - (overlapFactor - 1);
+        outputSize = inputSize * scale;
+        unpaddedOutputSize = outputSize - 2 * synthesisPadSize;
+    }
 
-        std::vector<double> phases(frameSize);
-        std::vector<double> cumulativePhases(frameSize);
+    // the leading padding is already in the buffer
+    inputBuffer = std::vector<double>(2 * frameSize + analysisHopSize + maxBlockSize);
+    inputBase = 0;
+    inputEnd = analysisPadSize;
 
-        for (int i = 0; i < numFrames; i++)
-        {
-            std::vector<std::complex<double>> frame(frameSize);
-            std::vector<std::complex<double>> transformed(frameSize);
-            std::vector<std::complex<double>> buffer(frameSize);
+    // the stretched samples that are still needed span at most a frame and a hop
+    std::size_t outputCapacity = 1;
+    while (outputCapacity < (std::size_t) frameSize + synthesisHopSize + 2)
+    {
+        outputCapacity <<= 1;
+    }
+    outputBuffer = std::vector<double>(outputCapacity);
+    outputMask = outputCapacity - 1;
+    outputBase = 0;
 
-            // analysis
+    framesProcessed = 0;
+    numSamplesPulled = 0;
 
-            // apply window
-            int left = i * analysisHopSize;
-            for (int k = 0; k < frameSize; k++)
-            {
-                frame[k] = input[left + k] * window[k] / std::sqrt(((double) frameSize / analysisHopSize) / 2.0);
-            }
+    phases = std::vector<double>(frameSize);
+    cumulativePhases = std::vector<double>(frameSize);
+    frame = std::vector<std::complex<double>>(frameSize);
+    buffer = std::vector<std::complex<double>>(frameSize);
+    transformed = std::vector<std::complex<double>>(frameSize);
+    scratch = std::vector<std::complex<double>>(frameSize);
+}
 
-            // transform to frequency domain
-            transformed = transformer.fft(frame, frameSize);
-            buffer = std::vector<std::complex<double>>(frameSize);
+void PitchShifter::Stream::push(const double* input, std::size_t count)
+{
+    // drop input which no frame needs anymore
+    uint64_t consumed = framesProcessed * analysisHopSize - inputBase;
+    if (consumed > 0)
+    {
+        std::memmove(inputBuffer.data(), inputBuffer.data() + consumed, (inputEnd - inputBase - consumed) * sizeof(double));
+        inputBase += consumed;
+    }
 
-            for (int k = 0; k < frameSize; k++)
-            {
-                // std::abs(const std::complex<T>& x) calculates the magnitude of x
-                double magnitude = std::abs(transformed[k]);
+    // the output has to be pulled before more input is pushed
+    assert(inputEnd - inputBase + count <= inputBuffer.size());
+    std::memcpy(inputBuffer.data() + (inputEnd - inputBase), input, count * sizeof(double));
+    inputEnd += count;
+}
+
+void PitchShifter::Stream::finish()
+{
+    finished = true;
+}
+
+uint64_t PitchShifter::Stream::getNumSamplesPulled()
+{
+    return numSamplesPulled;
+}
+
+uint64_t PitchShifter::Stream::getFinalisedSize()
+{
+    // no later frame overlaps the stretched output before the start of the next frame
+    if (numSamples > 0 && framesProcessed == numFrames)
+    {
+        return outputSize;
+    }
+    return framesProcessed * synthesisHopSize;
+}
 
-                // std::arg(const std::complex<T>& x) calculates the phase of x
-                double phase = std::arg(transformed[k]);
+void PitchShifter::Stream::releaseOutput(uint64_t end)
+{
+    // clear stretched samples that have been resampled so that they can be overlap added again
+    for (; outputBase < end; outputBase++)
+    {
+        outputBuffer[outputBase & outputMask] = 0.0;
+    }
+}
+
+bool PitchShifter::Stream::processFrame()
+{
+    int frameSize = shifter.frameSize;
+    uint64_t left = framesProcessed * analysisHopSize;
+    if (numSamples > 0 && framesProcessed == numFrames)
+    {
+        return false;
+    }
+
+    // wait for a full frame unless the rest of the input is zero padding
+    if (left + frameSize > inputEnd && !finished)
+    {
+        return false;
+    }
+
+    // analysis
+    // each stage is timed separately when profiling
 
-                // processing
+    // apply window
+    {
+        PROFILE_SCOPE("window");
+        for (int k = 0; k < frameSize; k++)
+        {
+            uint64_t index = left + k;
+            double sample = index < inputEnd ? inputBuffer[index - inputBase] : 0.0;
+            frame[k] = std::complex<double>(sample) * shifter.window[k] / windowNormalisation;
+        }
+    }
+
+    // transform to frequency domain
+    // nothing is allocated once the stream has been constructed, so live audio can be shifted
+    {
+        PROFILE_SCOPE("fft");
+        shifter.transformer.fft(frame.data(), transformed.data(), scratch.data(), frameSize);
+    }
+
+    {
+        PROFILE_SCOPE("phase");
+        for (int k = 0; k < frameSize; k++)
+        {
+            // std::abs(const std::complex<T>& x) calculates the magnitude of x
+            double magnitude = std::abs(transformed[k]);
 
-                // calculate phase difference
-                double deltaPhase = phase - phases[k] - omegas[k] * analysisHopSize;
+            // std::arg(const std::complex<T>& x) calculates the phase of x
+            double phase = std::arg(transformed[k]);
 
-                // constrain phase difference to [-π, π]
-                // std::fmod doesn't work with negative numbers, so make this positive first
-                if (deltaPhase < 0)
-                {
-                    deltaPhase += std::ceil(-deltaPhase / (2.0 * M_PI)) * 2.0 * M_PI;
-                }
-                deltaPhase = std::fmod(deltaPhase + M_PI, 2.0 * M_PI) - M_PI;
-                phases[k] = phase;
+            // processing
 
-                double trueFrequency = omegas[k] + deltaPhase / analysisHopSize;
-                cumulativePhases[k] += trueFrequency * synthesisHopSize;
+            // calculate phase difference
+            double deltaPhase = phase - phases[k] - shifter.omegas[k] * analysisHopSize;
 
-                buffer[k] = magnitude * std::complex<double>(
-                    std::cos(cumulativePhases[k]),
-                    std::sin(cumulativePhases[k])
-                );
+            // constrain phase difference to [-π, π]
+            // std::fmod doesn't work with negative numbers, so make this positive first
+            if (deltaPhase < 0)
+            {
+                deltaPhase += std::ceil(-deltaPhase / (2.0 * M_PI)) * 2.0 * M_PI;
             }
+            deltaPhase = std::fmod(deltaPhase + M_PI, 2.0 * M_PI) - M_PI;
+            phases[k] = phase;
+
+            double trueFrequency = shifter.omegas[k] + deltaPhase / analysisHopSize;
+            cumulativePhases[k] += trueFrequency * synthesisHopSize;
 
-            // synthesis
-            // apply window when recombining data for smoothing
-            transformed = transformer.ifft(buffer, frameSize);
-            left = i * synthesisHopSize;
-            for (int k = 0; k < frameSize; k++)
-            {
-                if (left + k >= outputSize)
-                {
-                    break;
-                }
-                output[left + k] += transformed[k].real() * window[k];
+            // without an end the phases would grow until they lose precision
+            if (numSamples == 0)
+            {
+                cumulativePhases[k] = std::remainder(cumulativePhases[k], 2.0 * M_PI);
             }
+
+            buffer[k] = magnitude * std::complex<double>(
+                std::cos(cumulativePhases[k]),
+                std::sin(cumulativePhases[k])
+            );
+        }
+    }
+
+    // synthesis
+    // apply window when recombining data for smoothing
+    {
+        PROFILE_SCOPE("ifft");
+        shifter.transformer.ifft(buffer.data(), transformed.data(), scratch.data(), frameSize);
+    }
+
+    PROFILE_SCOPE("overlap-add");
+    uint64_t outputLeft = framesProcessed * synthesisHopSize;
+    for (int k = 0; k < frameSize; k++)
+    {
+        uint64_t index = outputLeft + k;
+        if (numSamples > 0 && index >= outputSize)
+        {
+            break;
+        }
+
+        // the leading padding is never resampled
+        if (index >= outputBase)
+        {
+            outputBuffer[index & outputMask] += transformed[k].real() * shifter.window[k];
         }
+    }
 
-        // remove scaled padding
-        int synthesisPadSize = synthesisHopSize * (overlapFactor - 1);
-        int unpaddedOutputSize = outputSize - 2 * synthesisPadSize;
+    framesProcessed++;
+    return true;
+}
 
-        // resample output vector with linear interpolation
+std::size_t PitchShifter::Stream::pull(double* output, std::size_t count)
+{
+    // frames processed on demand are timed by their own stages, which leaves resampling as the self time
+    PROFILE_SCOPE("resample");
+    std::size_t numPulled = 0;
+    while (numPulled < count && (numSamples == 0 || numSamplesPulled < numSamples))
+    {
+        // remove scaled padding and resample output with linear interpolation
         // https://paulbourke.net/miscellaneous/interpolation/
-        for (int i = 0; i < file.numSamples; i++)
+        double x = numSamples > 0
+            ? synthesisPadSize + (double) numSamplesPulled / numSamples * unpaddedOutputSize
+            : synthesisPadSize + (double) numSamplesPulled * synthesisHopSize / analysisHopSize;
+        uint64_t left = (uint64_t) std::floor(x);
+        uint64_t right = (uint64_t) std::ceil(x);
+        if (numSamples > 0 && right >= outputSize)
         {
-            double x = synthesisPadSize + (double) i / file.numSamples * unpaddedOutputSize;
-            if (std::ceil(x) >= outputSize)
+            // only reachable without overlap, since the padding is never resampled otherwise
+            right = outputSize - 1;
+            left = std::min(left, right);
+        }
+
+        // both samples must have received every frame that overlaps them
+        releaseOutput(left);
+        while (right >= getFinalisedSize())
+        {
+            if (!processFrame())
             {
-                break;
+                return numPulled;
             }
-
-            double y1 = output[std::floor(x)];
-            double y2 = output[std::ceil(x)];
-            double ratio = x - std::floor(x);
-            file.samples[channel][i] = y1 * (1.0 - ratio) + y2 * ratio;
         }
+
+        double y1 = outputBuffer[left & outputMask];
+        double y2 = outputBuffer[right & outputMask];
+        double ratio = x - std::floor(x);
+        output[numPulled] = y1 * (1.0 - ratio) + y2 * ratio;
+        numPulled++;
+        numSamplesPulled++;
     }
+    return numPulled;
 }
 
 std::vector<double> PitchShifter::hanningWindow(int frameSize)
@@ -169,4 +603,4 @@ std::vector<double> PitchShifter::hanningWindow(int frameSize)
         n += 2;
     }
     return window;
-}
+}
\ No newline at end of file
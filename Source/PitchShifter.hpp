@@ -3,20 +3,127 @@
 
 #include "FourierTransformer.hpp"
 #include "WaveFile.hpp"
+#include "WaveReader.hpp"
+#include "WaveWriter.hpp"
 
+#include <complex>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 class PitchShifter
 {
 public:
-    void shift(WaveFile& file, int steps);
+    // number of samples per channel that are pushed through a Stream at a time
+    static const std::size_t BLOCK_SIZE = 1 << 14;
+
+    // blocks that can be waiting between 2 stages of a pipelined shift
+    static const std::size_t PIPELINE_DEPTH = 4;
+
+    // shifts a single channel incrementally, so the input never has to fit in memory
+    // input is pushed in blocks and the shifted output can be pulled as soon as it is final
+    class Stream
+    {
+    public:
+        // numSamples is the length of the input, or 0 if the input has no end (e.g. live audio)
+        // at most maxBlockSize samples may be pushed before the available output is pulled
+        Stream(PitchShifter& shifter, int steps, uint64_t numSamples, std::size_t maxBlockSize);
+
+        void push(const double* input, std::size_t count);
+
+        // marks the end of the input so that the rest of the output can be pulled
+        void finish();
+
+        // writes up to count shifted samples, returning how many were written
+        // fewer samples are written if more input has to be pushed first
+        std::size_t pull(double* output, std::size_t count);
+
+        uint64_t getNumSamplesPulled();
+
+    private:
+        PitchShifter& shifter;
+        uint64_t numSamples;
+        bool finished;
+
+        int analysisHopSize;
+        int synthesisHopSize;
+        uint64_t analysisPadSize;
+        uint64_t synthesisPadSize;
+        double windowNormalisation;
+
+        // sizes of the padded input and stretched output (only if numSamples is known)
+        uint64_t numFrames;
+        uint64_t outputSize;
+        uint64_t unpaddedOutputSize;
+
+        // input that has not been fully consumed by a frame
+        // inputBuffer[0] is the sample at inputBase of the padded input
+        std::vector<double> inputBuffer;
+        uint64_t inputBase;
+        uint64_t inputEnd;
+
+        // stretched output which is overlap added, stored in a ring buffer
+        // samples before outputBase have been resampled and are cleared for reuse
+        std::vector<double> outputBuffer;
+        uint64_t outputMask;
+        uint64_t outputBase;
+
+        uint64_t framesProcessed;
+        uint64_t numSamplesPulled;
+
+        std::vector<double> phases;
+        std::vector<double> cumulativePhases;
+        std::vector<std::complex<double>> frame;
+        std::vector<std::complex<double>> buffer;
+        std::vector<std::complex<double>> transformed;
+        std::vector<std::complex<double>> scratch;
+
+        bool processFrame();
+        uint64_t getFinalisedSize();
+        void releaseOutput(uint64_t end);
+    };
+
     PitchShifter(int frameSize, int overlapFactor);
+    void shift(WaveFile& file, int steps);
+
+    int getFrameSize() const;
+    int getOverlapFactor() const;
+
+    // onProgress is called with the fraction of the file that has been shifted
+    // returning false from it cancels the shift, leaving the file partially shifted
+    // returns false if the shift was cancelled
+    bool shift(WaveFile& file, int steps, const std::function<bool(double)>& onProgress);
+
+    // shifts every channel together, so the file is shifted from start to end
+    // onShifted is called with the number of samples at the start of every channel that are final,
+    // which can be read while the rest of the file is being shifted
+    // returning false from it cancels the shift
+    bool shiftProgressively(WaveFile& file, int steps, const std::function<bool(uint64_t)>& onShifted);
+    void shift(WaveReader& input, WaveWriter& output, int steps);
+
+    // same as above, onProgress is called after each block and can cancel the shift
+    bool shift(WaveReader& input, WaveWriter& output, int steps, const std::function<bool(double)>& onProgress);
+
+    // same as above, except that decoding, shifting and encoding run at the same time on 3 threads
+    // the stages pass blocks through bounded queues, so at most 2 * PIPELINE_DEPTH blocks are in memory
+    // and a stage that gets ahead waits for the next one
+    // the output is identical to the sequential shift, and the calling thread does the shifting
+    void shiftPipelined(WaveReader& input, WaveWriter& output, int steps);
+
+    // shifts one channel of numSamples from input into output, which can be the same as input
+    // the result is the same as shifting that channel of a WaveFile
+    // the shifter itself is only read, so several channels can be shifted with it at once on different threads
+    void shift(const double* input, double* output, uint64_t numSamples, int steps);
 
 private:
     int frameSize;
     int overlapFactor;
     FourierTransformer transformer;
 
+    // necessary for smoothing
+    std::vector<double> window;
+    std::vector<double> omegas;
+
     std::vector<double> hanningWindow(int frameSize);
 };
 
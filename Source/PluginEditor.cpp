@@ -12,7 +12,9 @@
 //==============================================================================
 SamplerAudioProcessorEditor::SamplerAudioProcessorEditor(SamplerAudioProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p),
-    keyboard(audioProcessor.getKState(), juce::MidiKeyboardComponent::horizontalKeyboard), ActionListener()
+    keyboard(audioProcessor.getKState(), juce::MidiKeyboardComponent::horizontalKeyboard),
+    waveformView([this] { return audioProcessor.getWaveformOverview(); }),
+    monitorView(audioProcessor.getRealtimeMonitor()), ActionListener()
     //editor must inherit constructor from juce::midiKeyboard in order to create the keyboard component
     //editor inherits from listener in order to receive change to pluginStatusDisplay in processor
 
@@ -30,6 +32,7 @@ SamplerAudioProcessorEditor::SamplerAudioProcessorEditor(SamplerAudioProcessor&
     addAndMakeVisible(mLoadButton);
     addAndMakeVisible(keyboard);
     addAndMakeVisible(pluginStateDisplay);
+    addAndMakeVisible(waveformView);
 
 
     //modulation components
@@ -52,8 +55,7 @@ SamplerAudioProcessorEditor::SamplerAudioProcessorEditor(SamplerAudioProcessor&
             currentKeyDisplay.setText(juce::String(audioProcessor.getKey() - 1), juce::dontSendNotification);
             audioProcessor.downKey();
         }
-
-        if (audioProcessor.getKey() == 1) {
+        else if (audioProcessor.getKey() == 1) {
             pluginStateDisplay.setText("Modulation in progress", juce::dontSendNotification);
             currentKeyDisplay.setText(juce::String(0), juce::dontSendNotification);
             audioProcessor.addOriginalSound();
@@ -67,6 +69,76 @@ SamplerAudioProcessorEditor::SamplerAudioProcessorEditor(SamplerAudioProcessor&
             downKeyButton.setEnabled(audioProcessor.isFileLoaded());
         };
 
+    addAndMakeVisible(perKeyButton);
+    perKeyButton.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+    perKeyButton.setToggleState(audioProcessor.isPerKeyShifting(), juce::dontSendNotification);
+    perKeyButton.onClick = [this]
+        {
+            audioProcessor.setPerKeyShifting(perKeyButton.getToggleState());
+        };
+
+    addAndMakeVisible(liveButton);
+    liveButton.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+    liveButton.setToggleState(audioProcessor.isLiveShifting(), juce::dontSendNotification);
+    liveButton.onClick = [this]
+        {
+            audioProcessor.setLiveShifting(liveButton.getToggleState());
+        };
+
+    // the item ids are the frame sizes, smaller frames have less latency but lower quality
+    addAndMakeVisible(frameSizeBox);
+    for (int frameSize : { 512, 1024, 2048, 4096 })
+    {
+        frameSizeBox.addItem(juce::String(frameSize) + " samples", frameSize);
+    }
+    frameSizeBox.setSelectedId(audioProcessor.getLiveFrameSize(), juce::dontSendNotification);
+    frameSizeBox.onChange = [this]
+        {
+            audioProcessor.setLiveFrameSize(frameSizeBox.getSelectedId());
+        };
+
+    addAndMakeVisible(streamButton);
+    streamButton.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+    streamButton.setToggleState(audioProcessor.isStreaming(), juce::dontSendNotification);
+    streamButton.onClick = [this]
+        {
+            audioProcessor.setStreaming(streamButton.getToggleState());
+        };
+
+    // the item ids are the read-ahead budgets in megabytes, shared by all the voices
+    addAndMakeVisible(streamBudgetBox);
+    for (int megabytes : { 16, 64, 256 })
+    {
+        streamBudgetBox.addItem(juce::String(megabytes) + " MB read-ahead", megabytes);
+    }
+    streamBudgetBox.setSelectedId((int) (audioProcessor.getStreamingMemoryBudget() >> 20), juce::dontSendNotification);
+    streamBudgetBox.onChange = [this]
+        {
+            audioProcessor.setStreamingMemoryBudget((std::size_t) streamBudgetBox.getSelectedId() << 20);
+        };
+
+    addAndMakeVisible(profileButton);
+    profileButton.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+    profileButton.setToggleState(audioProcessor.isProfiling(), juce::dontSendNotification);
+    profileButton.onClick = [this]
+        {
+            audioProcessor.setProfiling(profileButton.getToggleState());
+        };
+
+    // switching the monitor on starts over from an empty histogram
+    addAndMakeVisible(monitorButton);
+    monitorButton.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+    monitorButton.setToggleState(audioProcessor.getRealtimeMonitor().isEnabled(), juce::dontSendNotification);
+    monitorButton.onClick = [this]
+        {
+            if (monitorButton.getToggleState())
+            {
+                audioProcessor.getRealtimeMonitor().reset();
+            }
+            audioProcessor.getRealtimeMonitor().setEnabled(monitorButton.getToggleState());
+        };
+    addAndMakeVisible(monitorView);
+
     addAndMakeVisible(currentKeyDisplay);
     currentKeyDisplay.setColour(juce::Label::backgroundColourId, juce::Colours::white);
     currentKeyDisplay.setColour(juce::Label::textColourId, juce::Colours::black);
@@ -86,7 +158,7 @@ SamplerAudioProcessorEditor::SamplerAudioProcessorEditor(SamplerAudioProcessor&
     currentStatusLabel.setColour(juce::Label::textColourId, juce::Colours::whitesmoke);
     currentStatusLabel.setColour(juce::Label::backgroundColourId, juce::Colours::darkgrey);
 
-    setSize(750, 300);
+    setSize(750, 510);
 }
 
 SamplerAudioProcessorEditor::~SamplerAudioProcessorEditor()
@@ -110,12 +182,21 @@ void SamplerAudioProcessorEditor::resized()
     mLoadButton.setBounds(getWidth() / 2 - 300, getHeight() / 2 - 84, 100, 60);
     keyboard.setBounds(getWidth() / 2 - 300, getHeight() / 2 - 15, 600, 150);
     pluginStateDisplay.setBounds(getWidth() / 2 - 190, getHeight() / 2 - 60, 300, 36);
+    waveformView.setBounds(getWidth() / 2 - 300, getHeight() / 2 + 145, 600, 60);
 
     //modulation components
     upKeyButton.setBounds(getWidth() - 140, getHeight() / 2 - 52, 60, 27);
     downKeyButton.setBounds(getWidth() - 260, getHeight() / 2 - 52, 60, 27);
     currentKeyDisplay.setBounds(getWidth() - 200, getHeight() / 2 - 52, 60, 27);
     enableModulationButton.setBounds(getWidth() - 260, getHeight() / 2 - 79, 180, 27);
+    perKeyButton.setBounds(getWidth() - 260, getHeight() / 2 - 106, 180, 27);
+    liveButton.setBounds(getWidth() - 260, getHeight() / 2 - 133, 180, 27);
+    frameSizeBox.setBounds(getWidth() - 260, getHeight() / 2 - 160, 180, 27);
+    streamButton.setBounds(getWidth() / 2 - 300, getHeight() / 2 - 160, 180, 27);
+    streamBudgetBox.setBounds(getWidth() / 2 - 300, getHeight() / 2 - 133, 180, 27);
+    profileButton.setBounds(getWidth() - 260, getHeight() / 2 - 187, 180, 27);
+    monitorButton.setBounds(getWidth() - 260, getHeight() / 2 - 214, 180, 27);
+    monitorView.setBounds(getWidth() / 2 - 300, getHeight() / 2 + 212, 600, 40);
     
 }
 
@@ -11,6 +11,8 @@
 #include <JuceHeader.h>
 
 #include "PluginProcessor.h"
+#include "RealtimeMonitorView.h"
+#include "WaveformView.h"
 
 //==============================================================================
 /**
@@ -40,6 +42,15 @@ private:
   juce::TextButton upKeyButton{ "+" };
   juce::TextButton downKeyButton{ "-" };
   juce::TextButton enableModulationButton{ "Enable Modulation" };
+  juce::ToggleButton perKeyButton{ "Shift Each Key" };
+  juce::ToggleButton liveButton{ "Shift Live Input" };
+  juce::ComboBox frameSizeBox;
+  juce::ToggleButton streamButton{ "Stream From Disk" };
+  juce::ComboBox streamBudgetBox;
+  juce::ToggleButton profileButton{ "Profile Renders" };
+  juce::ToggleButton monitorButton{ "Monitor Audio Thread" };
+  RealtimeMonitorView monitorView;
+  WaveformView waveformView;
   juce::Label currentKeyDisplay;
   juce::Label modulationLabel;
   juce::Label currentStatusLabel;
@@ -9,14 +9,26 @@
 #include "PitchShifter.hpp"
 #include "PluginEditor.h"
 #include "PluginProcessor.h"
+#include "Profiler.hpp"
+#include "RenderCache.hpp"
 #include "WaveFile.hpp"
+#include "WaveReader.hpp"
+#include "WaveWriter.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
 
 //==============================================================================
 SamplerAudioProcessor::SamplerAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
     : AudioProcessor(BusesProperties()
 #if ! JucePlugin_IsMidiEffect
-#if ! JucePlugin_IsSynth
+        // the input is only used when it is shifted live, so the synth can run without it
+#if JucePlugin_IsSynth
+        .withInput("Input", juce::AudioChannelSet::stereo(), false)
+#else
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
 #endif
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)
@@ -26,19 +38,47 @@ SamplerAudioProcessor::SamplerAudioProcessor()
 #endif
 {
 
-    mFormatManager.registerBasicFormats();
-
-    for (int i = 0; i < mNumVoices; i++)
+    // the voices and the sound are added once, re-pitching only replaces what is in the slot
+    numVoicesParameter = new juce::AudioParameterInt("voices", "Voices", 1, MAX_VOICES, DEFAULT_VOICES);
+    addParameter(numVoicesParameter);
+    for (int i = 0; i < MAX_VOICES; i++)
     {
-        mSampler.addVoice(new juce::SamplerVoice());
+        streamers.push_back(std::make_unique<SampleStreamer>());
+        mSampler.addVoice(new SlotVoice(soundSlot, variants, *streamers.back(), voiceScratch, i, numActiveVoices));
     }
+    prepareStreamers();
+    for (auto& streamer : streamers)
+    {
+        streamThread.addTimeSliceClient(streamer.get());
+    }
+    streamThread.startThread();
+    mSampler.addSound(new SlotSound());
     stateDisplayText.setValue("Please load a file first");
+
+    // the status only changes once per percent, so the message thread is not flooded
+    scheduler.onProgress = [this](int pitch, double progress)
+        {
+            int percent = (int) (progress * 100.0);
+            if (reportedPercent.exchange(percent) != percent)
+            {
+                juce::String status = renderIsPlayable ? "Playable, still rendering... " : "Modulation in progress... ";
+                sendActionMessage(status + juce::String(percent) + "%");
+            }
+        };
+    scheduler.onFinished = [this](int pitch)
+        {
+            reportedPercent = -1;
+            sendActionMessage("Keyboard is ready");
+        };
 }
 
 SamplerAudioProcessor::~SamplerAudioProcessor()
 {
-    mFormatReader = nullptr;
-    remove("./temp.wav");
+    // the voices release their samples into the slots, so they must go before the slots do
+    // and so must the streamers, which hold on to the samples they are reading
+    mSampler.clearVoices();
+    streamThread.stopThread(1000);
+    streamers.clear();
 }
 
 
@@ -83,7 +123,13 @@ bool SamplerAudioProcessor::isMidiEffect() const
 
 double SamplerAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // live input keeps coming out for the length of the delay,
+    // and notes fade out over the release of the voices' envelope
+    if (liveShifting && getSampleRate() > 0.0)
+    {
+        return liveShifter.getLatencySamples() / getSampleRate();
+    }
+    return 0.1;
 }
 
 int SamplerAudioProcessor::getNumPrograms()
@@ -116,12 +162,29 @@ void SamplerAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     mSampler.setCurrentPlaybackSampleRate(sampleRate);
+    realtimeMonitor.prepare(sampleRate);
+
+    // the clip is rendered again at the new rate in the background, so the voices play it at 1:1
+    uint32_t rate = (uint32_t) std::lround(sampleRate);
+    if (hostSampleRate.exchange(rate) != rate)
+    {
+        restartRenders();
+    }
+
+    // the voices take turns rendering into this before mixing into the output
+    voiceScratch.setSize(SlotVoice::NUM_SCRATCH_CHANNELS, juce::jmax(samplesPerBlock, SlotVoice::MIN_SCRATCH_SIZE));
+
+    // the live shift allocates everything it needs for blocks of up to samplesPerBlock here
+    prepareLiveShift(samplesPerBlock);
 }
 
 void SamplerAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    soundSlot.collectGarbage();
+    variants.getSlots().collectGarbage();
+    liveShifter.reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -140,7 +203,11 @@ bool SamplerAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) c
         return false;
 
     // This checks if the input layout matches the output layout 
-#if ! JucePlugin_IsSynth
+#if JucePlugin_IsSynth
+    if (!layouts.getMainInputChannelSet().isDisabled()
+        && layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+#else
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
 #endif
@@ -152,11 +219,39 @@ bool SamplerAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) c
 
 void SamplerAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    // everything below counts against the block's deadline
+    RealtimeMonitor::BlockScope monitorScope(realtimeMonitor, buffer.getNumSamples());
+
+    // the live shift's stages are profiled too, into a buffer reserved when profiling starts
+    Profiler::RealtimeScope profilerScope;
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     kState.processNextMidiBuffer(midiMessages, 0, buffer.getNumSamples(), true); //to allow our keyboard to send midimessages to be received by midibuffer
+
+    // the input is shifted in place and the sampler plays on top of it
+    if (liveShifting)
+    {
+        liveShifter.process(buffer, juce::jmin(totalNumInputChannels, totalNumOutputChannels));
+        for (int channel = totalNumInputChannels; channel < totalNumOutputChannels; channel++)
+        {
+            buffer.clear(channel, 0, buffer.getNumSamples());
+        }
+    }
+    else
+    {
+        // the input bus is only there for the live shift, so its input never passes through on its own
+        buffer.clear();
+    }
+
+    numActiveVoices = numVoicesParameter->get();
+
+    // voices only acquire samples from the slot inside this bracket
+    soundSlot.beginBlock();
+    variants.getSlots().beginBlock();
     mSampler.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+    variants.getSlots().endBlock();
+    soundSlot.endBlock();
 }
 
 //==============================================================================
@@ -197,61 +292,417 @@ void SamplerAudioProcessor::loadFile()
 
             if (file != juce::File{})                                                // [9]
             {
-                mFormatReader = mFormatManager.createReaderFor(file);                 // [10]
-                if (mFormatReader != nullptr)
-                {
-                    mSampler.addSound(new juce::SamplerSound("Sample", *mFormatReader, juce::BigInteger().setRange(0, 128, true), 72, 0.1, 0.1, 10.0));
-                    audioClip = file; //assigning the file to processor
-                    currentPitch = 0;
-                    sendActionMessage("Keyboard is ready");
-                }
+                loadClip(file);
             }
         });
 
 }
 
+void SamplerAudioProcessor::loadClip(const juce::File& file)
+{
+    // decode the clip once, every shift then starts from the samples in memory
+    // a streamed clip is only read from disk when it is shifted or played
+    std::string path = file.getFullPathName().toStdString();
+    auto clip = std::make_shared<const SourceClip>(path, streaming);
+    if (clip->file->numSamples > 0)
+    {
+        // a render of the old clip is cancelled as soon as the new one is requested
+        std::atomic_store(&sourceClip, clip);
+        std::atomic_store(&waveformOverview, std::shared_ptr<const WaveformOverview>());
+        audioClip = file; //assigning the file to processor
+        currentPitch = 0;
+        variants.clear();
+        variants.setBasePitch(0);
+        scheduler.restart(0);
+        updateLiveShift();
+    }
+}
+
 void SamplerAudioProcessor::upKey() {
-    std::thread work([&]
-        {
-            sendActionMessage("Modulation in progress...");
-            currentPitch++;
-            WaveFile toBeShifted = WaveFile(audioClip.getFullPathName().toStdString());
-            shifter.shift(toBeShifted, currentPitch);
-            remove("./temp.wav");
-            toBeShifted.write("./temp.wav");
-            juce::File shifted = juce::File("./temp.wav");
-            mFormatReader = mFormatManager.createReaderFor(shifted);
-            mSampler.addSound(new juce::SamplerSound("Sample", *mFormatReader, juce::BigInteger().setRange(0, 128, true), 72, 0.1, 0.1, 10.0));
-            sendActionMessage("Keyboard is ready");
-        });
-    work.detach();
+    // renders run on the scheduler's thread, and only the latest pitch is rendered
+    sendActionMessage("Modulation in progress...");
+    int pitch = ++currentPitch;
+    variants.setBasePitch(pitch);
+    scheduler.request(pitch);
+    updateLiveShift();
 }
 
 void SamplerAudioProcessor::downKey() {
-    std::thread work([&]
-        {
-            sendActionMessage("Modulation in progress...");
-            currentPitch--;
-            WaveFile toBeShifted = WaveFile(audioClip.getFullPathName().toStdString());
-            shifter.shift(toBeShifted, currentPitch); //alot of distortion when downkey
-            remove("./temp.wav");
-            toBeShifted.write("./temp.wav");
-            juce::File shifted = juce::File("./temp.wav");
-            mFormatReader = mFormatManager.createReaderFor(shifted);
-            mSampler.addSound(new juce::SamplerSound("Sample", *mFormatReader, juce::BigInteger().setRange(0, 128, true), 72, 0.1, 0.1, 10.0));
-            sendActionMessage("Keyboard is ready");
-        });
-    work.detach();
+    sendActionMessage("Modulation in progress...");
+    int pitch = --currentPitch;
+    variants.setBasePitch(pitch);
+    scheduler.request(pitch); //alot of distortion when downkey
+    updateLiveShift();
 }
 
 void SamplerAudioProcessor::addOriginalSound() {
-    std::thread work([&] {
-        currentPitch--;
-        mFormatReader = mFormatManager.createReaderFor(audioClip);
-        mSampler.addSound(new juce::SamplerSound("Sample", *mFormatReader, juce::BigInteger().setRange(0, 128, true), 72, 0.1, 0.1, 10.0));
-        sendActionMessage("Keyboard is ready");
+    currentPitch--;
+    variants.setBasePitch(0);
+    scheduler.request(0);
+    updateLiveShift();
+}
+
+// copies a cached render, so the sample doesn't depend on the file staying in the cache
+static SampleBuffer copyRender(const RenderCache::Render& render)
+{
+    SampleBuffer samples(render.getNumChannels(), (std::size_t) render.getNumSamples());
+    for (uint32_t channel = 0; channel < render.getNumChannels(); channel++)
+    {
+        std::copy(render.getChannel(channel), render.getChannel(channel) + render.getNumSamples(), samples.getChannel(channel));
+    }
+    return samples;
+}
+
+bool SamplerAudioProcessor::addShiftedSound(int steps, const RepitchScheduler::ProgressFunction& onProgress)
+{
+    std::shared_ptr<const SourceClip> clip = std::atomic_load(&sourceClip);
+    if (clip == nullptr)
+    {
+        return true;
+    }
+
+    std::shared_ptr<const WaveFile> file = clip->getFileAtRate(hostSampleRate);
+    if (steps == 0 || file->samples.getNumSamples() == 0)
+    {
+        std::unique_ptr<ShiftedSample> sample = renderSample(*clip, steps, onProgress);
+        if (sample == nullptr)
+        {
+            return false;
+        }
+        // the overview is built from whichever copy of the samples is complete
+        std::shared_ptr<const WaveformOverview> overview = file->samples.getNumSamples() > 0
+            ? WaveformOverview::fromSamples(file->samples, file->numSamples)
+            : WaveformOverview::fromFile(sample->path);
+
+        // the synthesiser is never touched here, new notes pick up the sample from the slot
+        soundSlot.publish(std::move(sample));
+        std::atomic_store(&waveformOverview, overview);
+        return true;
+    }
+
+    // a cached render is already complete, so it is published at once
+    std::string key = RenderCache::getKey(RenderCache::hashAudio(file->samples, file->sampleRate), shifter, steps);
+    std::shared_ptr<const RenderCache::Render> cached = renderCache.load(key);
+    if (cached != nullptr)
+    {
+        SampleBuffer samples = copyRender(*cached);
+        soundSlot.publish(std::make_unique<ShiftedSample>(samples, cached->getSampleRate(), steps));
+        std::atomic_store(&waveformOverview, WaveformOverview::fromSamples(samples, cached->getNumSamples()));
+        return true;
+    }
+
+    // the clip is shifted from start to end and published as soon as its start is rendered
+    // nothing else publishes to the slot while this runs, so the sample stays alive while it is filled in
+    WaveFile toBeShifted = *file;
+    auto sample = std::make_unique<ShiftedSample>(toBeShifted.numChannels, toBeShifted.numSamples, toBeShifted.sampleRate, steps);
+    ShiftedSample* rendering = sample.get();
+    int playableLength = juce::jmin(rendering->length, (int) (toBeShifted.sampleRate * PLAYABLE_AFTER_SECONDS));
+    bool finished = shifter.shiftProgressively(toBeShifted, steps, [&](uint64_t numSamplesShifted)
+        {
+            rendering->render(toBeShifted.samples, numSamplesShifted);
+            if (sample != nullptr && rendering->renderedLength >= playableLength)
+            {
+                soundSlot.publish(std::move(sample));
+                renderIsPlayable = true;
+            }
+            return onProgress((double) numSamplesShifted / toBeShifted.numSamples);
         });
-    work.detach();
+    renderIsPlayable = false;
+
+    // a cancelled render that was already published keeps playing its start until the next one replaces it,
+    // which the scheduler renders even if it is for the pitch before this one
+    if (!finished)
+    {
+        return false;
+    }
+    if (sample != nullptr)
+    {
+        soundSlot.publish(std::move(sample));
+    }
+    renderCache.store(key, toBeShifted.samples, toBeShifted.sampleRate);
+    std::atomic_store(&waveformOverview, WaveformOverview::fromSamples(toBeShifted.samples, toBeShifted.numSamples));
+    return true;
+}
+
+std::unique_ptr<ShiftedSample> SamplerAudioProcessor::renderVariant(int offset, const std::function<bool()>& shouldStop)
+{
+    // runs on the variant cache's workers, several at once
+    // the shifter is only read while shifting, so it can be shared between them
+    std::shared_ptr<const SourceClip> clip = std::atomic_load(&sourceClip);
+    if (clip == nullptr)
+    {
+        return nullptr;
+    }
+    return renderSample(*clip, offset, [&](double progress) { return !shouldStop(); });
+}
+
+std::unique_ptr<ShiftedSample> SamplerAudioProcessor::renderSample(const SourceClip& clip, int steps,
+    const RepitchScheduler::ProgressFunction& onProgress)
+{
+    // returns nullptr if the render was cancelled
+    std::shared_ptr<const WaveFile> file = clip.getFileAtRate(hostSampleRate);
+    if (file->samples.getNumSamples() > 0)
+    {
+        if (steps == 0)
+        {
+            return std::make_unique<ShiftedSample>(file->samples, file->sampleRate, steps);
+        }
+
+        std::string key = RenderCache::getKey(RenderCache::hashAudio(file->samples, file->sampleRate), shifter, steps);
+        std::shared_ptr<const RenderCache::Render> cached = renderCache.load(key);
+        if (cached != nullptr)
+        {
+            return std::make_unique<ShiftedSample>(copyRender(*cached), cached->getSampleRate(), steps);
+        }
+
+        // shift a copy of the decoded clip and hand the samples straight to the voices as floats,
+        // instead of writing them to a file and decoding that file again
+        WaveFile toBeShifted = *file;
+        if (!shifter.shift(toBeShifted, steps, onProgress))
+        {
+            return nullptr;
+        }
+        renderCache.store(key, toBeShifted.samples, toBeShifted.sampleRate);
+        return std::make_unique<ShiftedSample>(toBeShifted.samples, toBeShifted.sampleRate, steps);
+    }
+
+    // a streamed clip is shifted from disk to a temporary file, one block at a time,
+    // so neither the clip nor the result is ever in memory as a whole
+    // streamed clips are played at their own rate
+    int headLength = (int) (file->sampleRate * STREAM_HEAD_SECONDS);
+    if (steps == 0)
+    {
+        return std::make_unique<ShiftedSample>(clip.path, headLength, steps, false);
+    }
+
+    std::string path = juce::File::getSpecialLocation(juce::File::tempDirectory)
+        .getNonexistentChildFile("Windigo", ".wav", false).getFullPathName().toStdString();
+    bool finished;
+    try
+    {
+        WaveReader reader(clip.path);
+        WaveWriter writer(path, reader.numChannels, reader.sampleRate, 32, true, reader.numSamples);
+        finished = shifter.shift(reader, writer, steps, onProgress);
+        writer.close();
+    }
+    catch (const std::runtime_error&)
+    {
+        // a temporary file that can't be written (e.g. the disk is full) is dropped like a cancelled render
+        finished = false;
+    }
+    if (!finished)
+    {
+        std::remove(path.c_str());
+        return nullptr;
+    }
+    // the sample deletes the file once no voice is playing it
+    return std::make_unique<ShiftedSample>(path, headLength, steps, true);
+}
+
+void SamplerAudioProcessor::setPerKeyShifting(bool shouldShiftEachKey)
+{
+    variants.setEnabled(shouldShiftEachKey);
+}
+
+bool SamplerAudioProcessor::isPerKeyShifting() const
+{
+    return variants.isEnabled();
+}
+
+void SamplerAudioProcessor::setLiveShifting(bool shouldShiftLive)
+{
+    liveShifting = shouldShiftLive;
+    setLatencySamples(shouldShiftLive ? liveShifter.getLatencySamples() : 0);
+
+    // key and frame size changes are not applied to the streams while the live shift is off,
+    // so they are remade when it is turned on
+    updateLiveShift();
+}
+
+bool SamplerAudioProcessor::isLiveShifting() const
+{
+    return liveShifting;
+}
+
+void SamplerAudioProcessor::setLiveFrameSize(int frameSize)
+{
+    // bigger frames resolve lower frequencies better, but delay the input for longer
+    liveFrameSize = frameSize;
+    updateLiveShift();
+}
+
+int SamplerAudioProcessor::getLiveFrameSize() const
+{
+    return liveFrameSize;
+}
+
+void SamplerAudioProcessor::setStreaming(bool shouldStream)
+{
+    if (streaming.exchange(shouldStream) == shouldStream)
+    {
+        return;
+    }
+
+    // every sample is rendered again the other way, starting with the key that is playing now
+    std::shared_ptr<const SourceClip> clip = std::atomic_load(&sourceClip);
+    if (clip != nullptr)
+    {
+        if (!shouldStream && clip->file->samples.getNumSamples() == 0)
+        {
+            std::atomic_store(&sourceClip, std::make_shared<const SourceClip>(clip->path, false));
+        }
+        restartRenders();
+    }
+}
+
+void SamplerAudioProcessor::restartRenders()
+{
+    if (isFileLoaded())
+    {
+        variants.clear();
+        scheduler.restart(currentPitch);
+    }
+}
+
+SamplerAudioProcessor::SourceClip::SourceClip(const std::string& path, bool headerOnly)
+    : path(path), file(std::make_shared<const WaveFile>(path, headerOnly))
+{
+}
+
+std::shared_ptr<const WaveFile> SamplerAudioProcessor::SourceClip::getFileAtRate(uint32_t sampleRate) const
+{
+    if (sampleRate == 0 || sampleRate == file->sampleRate || file->samples.getNumSamples() == 0)
+    {
+        return file;
+    }
+
+    // renders on several threads can ask at once, only the first one resamples
+    std::lock_guard<std::mutex> lock(resampleMutex);
+    if (resampled != nullptr && resampled->sampleRate == sampleRate)
+    {
+        return resampled;
+    }
+
+    // the resampled copy keeps the format of the decoded clip, so the file on disk is not needed again
+    double ratio = (double) file->sampleRate / sampleRate;
+    uint64_t numSamples = (uint64_t) std::ceil(file->numSamples / ratio);
+    auto result = std::make_shared<WaveFile>(*file, sampleRate, numSamples);
+
+    // the interpolator's output lags its input by its latency, so it is first fed that much at 1:1
+    // and the output that comes out after lines up with the start of the clip
+    // the input is padded with silence so the tail of the clip comes out too
+    int latency = (int) std::ceil(juce::WindowedSincInterpolator::getBaseLatency());
+    std::vector<float> input(file->numSamples + latency + (std::size_t) std::ceil(ratio) + 2, 0.0f);
+    std::vector<float> primed((std::size_t) juce::jmax(1, latency));
+    std::vector<float> output((std::size_t) numSamples);
+    for (uint32_t channel = 0; channel < file->numChannels; channel++)
+    {
+        const double* in = file->samples.getChannel(channel);
+        std::copy(in, in + file->numSamples, input.begin());
+
+        // the interpolator counts samples in ints, so long clips are resampled in chunks
+        // it keeps its state between calls, so the chunks join up seamlessly
+        juce::WindowedSincInterpolator interpolator;
+        const float* next = input.data() + interpolator.process(1.0, input.data(), primed.data(), latency);
+        for (uint64_t done = 0; done < numSamples; )
+        {
+            int count = (int) std::min<uint64_t>(numSamples - done, RESAMPLE_CHUNK_SIZE);
+            next += interpolator.process(ratio, next, output.data() + done, count);
+            done += (uint64_t) count;
+        }
+        std::copy(output.begin(), output.end(), result->samples.getChannel(channel));
+    }
+    resampled = result;
+    return resampled;
+}
+
+bool SamplerAudioProcessor::isStreaming() const
+{
+    return streaming;
+}
+
+void SamplerAudioProcessor::setStreamingMemoryBudget(std::size_t bytes)
+{
+    // the rings are reallocated, so neither the voices nor the stream thread can be using them
+    suspendProcessing(true);
+    streamThread.stopThread(1000);
+    streamingMemoryBudget = bytes;
+    prepareStreamers();
+    streamThread.startThread();
+    suspendProcessing(false);
+}
+
+std::size_t SamplerAudioProcessor::getStreamingMemoryBudget() const
+{
+    return streamingMemoryBudget;
+}
+
+void SamplerAudioProcessor::setProfiling(bool shouldProfile)
+{
+    if (shouldProfile == Profiler::isEnabled())
+    {
+        return;
+    }
+
+    // each render thread allocates its event buffer the first time it records anything,
+    // but the audio thread takes one reserved here (or one more if the host moves processing to another thread)
+    // renders that are still running when profiling stops finish their open stages untimed
+    if (shouldProfile)
+    {
+        Profiler::reserveRealtimeBuffers(2);
+        Profiler::clear();
+        Profiler::setEnabled(true);
+        return;
+    }
+    Profiler::setEnabled(false);
+
+    juce::File trace = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("Windigo-trace.json");
+    Profiler::writeChromeTrace(trace.getFullPathName().toStdString());
+    std::ostringstream summary;
+    Profiler::writeSummary(summary);
+    DBG(juce::String(summary.str()));
+    sendActionMessage("Profile saved to " + trace.getFullPathName());
+}
+
+bool SamplerAudioProcessor::isProfiling() const
+{
+    return Profiler::isEnabled();
+}
+
+RealtimeMonitor& SamplerAudioProcessor::getRealtimeMonitor()
+{
+    return realtimeMonitor;
+}
+
+void SamplerAudioProcessor::prepareStreamers()
+{
+    // each voice reads ahead into a stereo float ring, and every frame is in the ring twice
+    int ringLength = (int) (streamingMemoryBudget / (MAX_VOICES * 2 * 2 * sizeof(float)));
+    for (auto& streamer : streamers)
+    {
+        streamer->prepare(ringLength);
+    }
+}
+
+void SamplerAudioProcessor::prepareLiveShift(int samplesPerBlock)
+{
+    int numChannels = juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    liveShifter.prepare(numChannels, samplesPerBlock, liveFrameSize, currentPitch);
+    setLatencySamples(liveShifting ? liveShifter.getLatencySamples() : 0);
+}
+
+void SamplerAudioProcessor::updateLiveShift()
+{
+    // the shift and frame size are fixed when the streams are made,
+    // so they are remade between blocks with processing suspended
+    // that drops blocks of output, so it is only done while the live shift is on
+    if (!liveShifting || getSampleRate() <= 0.0)
+    {
+        return;
+    }
+    suspendProcessing(true);
+    prepareLiveShift(getBlockSize());
+    suspendProcessing(false);
 }
 
 int SamplerAudioProcessor::getKey()
@@ -259,9 +710,14 @@ int SamplerAudioProcessor::getKey()
     return currentPitch;
 }
 
+std::shared_ptr<const WaveformOverview> SamplerAudioProcessor::getWaveformOverview() const
+{
+    return std::atomic_load(&waveformOverview);
+}
+
 bool SamplerAudioProcessor::isFileLoaded()
 {
-    return mFormatReader != nullptr;
+    return std::atomic_load(&sourceClip) != nullptr;
 }
 
 //==============================================================================
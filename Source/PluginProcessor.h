@@ -10,7 +10,20 @@
 
 #include <JuceHeader.h>
 
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "LiveShifter.h"
 #include "PitchShifter.hpp"
+#include "RealtimeMonitor.h"
+#include "RenderCache.hpp"
+#include "RepitchScheduler.h"
+#include "SampleStreamer.h"
+#include "SlotVoice.h"
+#include "SoundSlot.h"
+#include "VariantCache.h"
+#include "WaveformOverview.h"
 #include "WaveFile.hpp"
 
 //==============================================================================
@@ -66,6 +79,34 @@ public:
   int getKey();
   bool isFileLoaded();
 
+  // plays each key from a variant shifted by its own distance from the root note
+  void setPerKeyShifting(bool shouldShiftEachKey);
+  bool isPerKeyShifting() const;
+
+  // shifts the input by the current key as an insert effect, delaying it by the frame size
+  void setLiveShifting(bool shouldShiftLive);
+  bool isLiveShifting() const;
+  void setLiveFrameSize(int frameSize);
+  int getLiveFrameSize() const;
+
+  // plays clips from disk, keeping only their heads and each voice's read-ahead in memory
+  // the read-ahead of all the voices together fits in the memory budget
+  void setStreaming(bool shouldStream);
+  bool isStreaming() const;
+  void setStreamingMemoryBudget(std::size_t bytes);
+  std::size_t getStreamingMemoryBudget() const;
+
+  // times each stage of the renders while enabled
+  // disabling saves the timeline as a Chrome trace in the temporary directory and logs a summary
+  void setProfiling(bool shouldProfile);
+  bool isProfiling() const;
+
+  // block loads, overruns, allocations and locks of processBlock, while it is enabled
+  RealtimeMonitor& getRealtimeMonitor();
+
+  // the overview of the sample the keyboard is playing, or nullptr until it is rendered
+  std::shared_ptr<const WaveformOverview> getWaveformOverview() const;
+
   //keyboard and display components
   juce::MidiKeyboardState& getKState();
   juce::Value stateDisplayText;
@@ -74,14 +115,87 @@ public:
 
 private:
   juce::Synthesiser mSampler;
-  const int mNumVoices = 3;
-  juce::AudioFormatManager mFormatManager;
-  juce::AudioFormatReader* mFormatReader = nullptr;
+  // every voice is made up front, the parameter only limits how many take new notes
+  static const int MAX_VOICES = 64;
+  static const int DEFAULT_VOICES = 32;
+  juce::AudioParameterInt* numVoicesParameter;
+  std::atomic<int> numActiveVoices{ DEFAULT_VOICES };
+  juce::AudioBuffer<float> voiceScratch;
+  SoundSlot soundSlot;
+
+  // the samples are only decoded if the clip is not streamed
+  // decoded samples are resampled to the host's rate once, by the first render that needs them
+  struct SourceClip
+  {
+    // longest run of samples that is resampled in one call
+    static const int RESAMPLE_CHUNK_SIZE = 1 << 20;
+
+    SourceClip(const std::string& path, bool headerOnly);
+
+    // returns the file itself if it is already at the rate, or if it is not decoded
+    std::shared_ptr<const WaveFile> getFileAtRate(uint32_t sampleRate) const;
+
+    std::string path;
+    std::shared_ptr<const WaveFile> file;
+    mutable std::mutex resampleMutex;
+    mutable std::shared_ptr<const WaveFile> resampled;
+  };
+  std::shared_ptr<const SourceClip> sourceClip;
+
+  // replaced whenever a render of the keyboard's sample finishes
+  std::shared_ptr<const WaveformOverview> waveformOverview;
+
+  RealtimeMonitor realtimeMonitor;
+
+  // 0 until the host has called prepareToPlay
+  std::atomic<uint32_t> hostSampleRate{ 0 };
+
+  // enough to start a note while its streamer opens the file
+  static constexpr double STREAM_HEAD_SECONDS = 0.5;
+  static const std::size_t DEFAULT_STREAMING_MEMORY_BUDGET = 64 << 20;
+  std::atomic<bool> streaming{ false };
+  std::size_t streamingMemoryBudget = DEFAULT_STREAMING_MEMORY_BUDGET;
+  juce::TimeSliceThread streamThread{ "Sample Streamer" };
+  std::vector<std::unique_ptr<SampleStreamer>> streamers;
   std::unique_ptr<juce::FileChooser> chooser;
   juce::MidiKeyboardState kState;
-  int currentPitch = 0;
+  std::atomic<int> currentPitch{ 0 };
+  std::atomic<int> reportedPercent{ -1 };
+
+  // a re-pitched clip is published once this much of it is rendered, and the rest fills in while it plays
+  static constexpr double PLAYABLE_AFTER_SECONDS = 0.3;
+  std::atomic<bool> renderIsPlayable{ false };
   PitchShifter shifter = PitchShifter(4096, 4);
 
+  // renders of in-memory clips are kept in the user's cache directory, which the demo can share,
+  // so shifting a clip by steps it was already shifted by (in this session or an earlier one) only maps the render
+  // streamed clips are never decoded as a whole, so they can't be hashed and are always shifted
+  RenderCache renderCache{ RenderCache::getDefaultDirectory() };
+  LiveShifter liveShifter;
+  std::atomic<bool> liveShifting{ false };
+  int liveFrameSize = LiveShifter::DEFAULT_FRAME_SIZE;
+
+  bool addShiftedSound(int steps, const RepitchScheduler::ProgressFunction& onProgress);
+  std::unique_ptr<ShiftedSample> renderSample(const SourceClip& clip, int steps, const RepitchScheduler::ProgressFunction& onProgress);
+  void restartRenders();
+  void loadClip(const juce::File& file);
+  void prepareStreamers();
+  std::unique_ptr<ShiftedSample> renderVariant(int offset, const std::function<bool()>& shouldStop);
+  void prepareLiveShift(int samplesPerBlock);
+  void updateLiveShift();
+
+  VariantCache variants{ [this](int offset, const std::function<bool()>& shouldStop)
+    {
+      return renderVariant(offset, shouldStop);
+    } };
+
+  // declared last so that its thread is stopped before anything it renders with is destroyed
+  // the variant cache's threads are stopped just after it
+  RepitchScheduler scheduler{ [this](int pitch, const RepitchScheduler::ProgressFunction& onProgress)
+    {
+      return addShiftedSound(pitch, onProgress);
+    } };
+
   //==============================================================================
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplerAudioProcessor)
 };
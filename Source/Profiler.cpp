@@ -0,0 +1,295 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <thread>
+
+std::atomic<bool> Profiler::enabled{ false };
+std::atomic<uint64_t> Profiler::epoch{ 0 };
+std::atomic<uint64_t> Profiler::numLostEvents{ 0 };
+std::mutex Profiler::buffersMutex;
+std::vector<std::unique_ptr<Profiler::ThreadBuffer>> Profiler::buffers;
+std::atomic<Profiler::ThreadBuffer*> Profiler::realtimeBuffers[MAX_REALTIME_BUFFERS] = {};
+thread_local bool Profiler::onRealtimeThread = false;
+
+Profiler::Scope::Scope(const char* name)
+    : name(name), start(0), active(isEnabled())
+{
+    if (active)
+    {
+        start = now();
+    }
+}
+
+Profiler::Scope::~Scope()
+{
+    if (active)
+    {
+        record({ name, 0, start, now() - start, false, 0 });
+    }
+}
+
+Profiler::RealtimeScope::RealtimeScope()
+    : wasRealtime(onRealtimeThread)
+{
+    onRealtimeThread = true;
+}
+
+Profiler::RealtimeScope::~RealtimeScope()
+{
+    onRealtimeThread = wasRealtime;
+}
+
+void Profiler::setEnabled(bool shouldBeEnabled)
+{
+    enabled = shouldBeEnabled;
+}
+
+void Profiler::count(const char* name, int64_t value)
+{
+    if (isEnabled())
+    {
+        record({ name, 0, now(), 0, true, value });
+    }
+}
+
+void Profiler::reserveRealtimeBuffers(std::size_t count)
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    count = std::min(count, (std::size_t) MAX_REALTIME_BUFFERS);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (realtimeBuffers[i].load() == nullptr)
+        {
+            realtimeBuffers[i].store(createBuffer());
+        }
+    }
+}
+
+void Profiler::clear()
+{
+    epoch++;
+    numLostEvents = 0;
+}
+
+int64_t Profiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Profiler::ThreadBuffer* Profiler::createBuffer()
+{
+    // the buffers are never freed, so they outlive the threads and can still be exported
+    // must be called with buffersMutex locked
+    buffers.push_back(std::make_unique<ThreadBuffer>());
+    ThreadBuffer* buffer = buffers.back().get();
+    buffer->events.resize(MAX_EVENTS_PER_THREAD);
+    buffer->threadId = (uint32_t) buffers.size();
+    buffer->epoch = epoch.load();
+    return buffer;
+}
+
+void Profiler::record(const Event& event)
+{
+    // each thread registers its buffer the first time it records anything
+    // a real-time thread takes one of the reserved buffers instead, so it never locks or allocates
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr && onRealtimeThread)
+    {
+        for (std::size_t i = 0; i < MAX_REALTIME_BUFFERS && buffer == nullptr; i++)
+        {
+            buffer = realtimeBuffers[i].exchange(nullptr);
+        }
+        if (buffer == nullptr)
+        {
+            numLostEvents++;
+            return;
+        }
+    }
+    else if (buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffer = createBuffer();
+    }
+
+    uint64_t currentEpoch = epoch.load();
+    if (buffer->epoch.load(std::memory_order_relaxed) != currentEpoch)
+    {
+        // the events of the old epoch may be being copied, in which case this event is lost instead of waiting
+        int idle = IDLE;
+        if (!buffer->state.compare_exchange_strong(idle, EMPTYING, std::memory_order_acquire))
+        {
+            numLostEvents++;
+            return;
+        }
+        buffer->size.store(0, std::memory_order_relaxed);
+        buffer->dropped = 0;
+        buffer->epoch.store(currentEpoch, std::memory_order_relaxed);
+        buffer->state.store(IDLE, std::memory_order_release);
+    }
+
+    // only this thread writes to its buffer, so the size is only published once the event is in place
+    std::size_t size = buffer->size.load(std::memory_order_relaxed);
+    if (size == MAX_EVENTS_PER_THREAD)
+    {
+        buffer->dropped++;
+        return;
+    }
+    buffer->events[size] = event;
+    buffer->events[size].threadId = buffer->threadId;
+    buffer->size.store(size + 1, std::memory_order_release);
+}
+
+void Profiler::beginReading(ThreadBuffer& buffer)
+{
+    // the owner empties its buffer in a few instructions, so this only ever waits briefly
+    int idle = IDLE;
+    while (!buffer.state.compare_exchange_weak(idle, READING, std::memory_order_acquire))
+    {
+        idle = IDLE;
+        std::this_thread::yield();
+    }
+}
+
+void Profiler::endReading(ThreadBuffer& buffer)
+{
+    buffer.state.store(IDLE, std::memory_order_release);
+}
+
+std::vector<Profiler::Event> Profiler::getEvents()
+{
+    // events that are appended while copying are either copied or left out whole,
+    // and the ones that are copied can't be emptied until the copy is done
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    uint64_t currentEpoch = epoch.load();
+    std::vector<Event> events;
+    for (const auto& buffer : buffers)
+    {
+        beginReading(*buffer);
+        if (buffer->epoch.load(std::memory_order_relaxed) == currentEpoch)
+        {
+            std::size_t size = buffer->size.load(std::memory_order_acquire);
+            events.insert(events.end(), buffer->events.begin(), buffer->events.begin() + size);
+        }
+        endReading(*buffer);
+    }
+    return events;
+}
+
+uint64_t Profiler::getNumDroppedEvents()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    uint64_t currentEpoch = epoch.load();
+    uint64_t dropped = numLostEvents;
+    for (const auto& buffer : buffers)
+    {
+        beginReading(*buffer);
+        if (buffer->epoch.load(std::memory_order_relaxed) == currentEpoch)
+        {
+            dropped += buffer->dropped;
+        }
+        endReading(*buffer);
+    }
+    return dropped;
+}
+
+void Profiler::writeChromeTrace(const std::string& filename)
+{
+    std::vector<Event> events = getEvents();
+    int64_t origin = events.empty() ? 0 : events[0].start;
+    for (const Event& event : events)
+    {
+        origin = std::min(origin, event.start);
+    }
+
+    // timestamps are in microseconds, complete events ("X") have a duration,
+    // and counters ("C") hold the running total of the counter
+    std::ofstream output(filename);
+    output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    std::map<std::string, int64_t> totals;
+    char line[256];
+    for (std::size_t i = 0; i < events.size(); i++)
+    {
+        const Event& event = events[i];
+        double timestamp = (event.start - origin) / 1000.0;
+        if (event.isCounter)
+        {
+            int64_t total = totals[event.name] += event.value;
+            std::snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%lld}}",
+                event.name, timestamp, event.threadId, (long long) total);
+        }
+        else
+        {
+            std::snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                event.name, timestamp, event.duration / 1000.0, event.threadId);
+        }
+        output << line << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    output << "]}\n";
+}
+
+void Profiler::writeSummary(std::ostream& output)
+{
+    struct Stage
+    {
+        uint64_t calls = 0;
+        int64_t total = 0;
+        int64_t self = 0;
+        int64_t longest = 0;
+        int64_t counted = 0;
+    };
+
+    // scopes end before the scopes around them, so sorting each thread's events by start
+    // puts every scope right after the one it is nested in
+    std::vector<Event> events = getEvents();
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b)
+        {
+            return a.threadId != b.threadId ? a.threadId < b.threadId : a.start < b.start;
+        });
+
+    std::map<std::string, Stage> stages;
+    std::vector<const Event*> open;
+    for (const Event& event : events)
+    {
+        Stage& stage = stages[event.name];
+        if (event.isCounter)
+        {
+            stage.counted += event.value;
+            continue;
+        }
+        stage.calls++;
+        stage.total += event.duration;
+        stage.self += event.duration;
+        stage.longest = std::max(stage.longest, event.duration);
+
+        while (!open.empty() && (open.back()->threadId != event.threadId
+            || open.back()->start + open.back()->duration <= event.start))
+        {
+            open.pop_back();
+        }
+        if (!open.empty())
+        {
+            stages[open.back()->name].self -= event.duration;
+        }
+        open.push_back(&event);
+    }
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-24s %10s %12s %12s %12s %14s\n", "stage", "calls", "total ms", "self ms", "longest ms", "count");
+    output << line;
+    for (const auto& entry : stages)
+    {
+        const Stage& stage = entry.second;
+        std::snprintf(line, sizeof(line), "%-24s %10llu %12.3f %12.3f %12.3f %14lld\n", entry.first.c_str(),
+            (unsigned long long) stage.calls, stage.total / 1e6, stage.self / 1e6, stage.longest / 1e6, (long long) stage.counted);
+        output << line;
+    }
+    uint64_t dropped = getNumDroppedEvents();
+    if (dropped > 0)
+    {
+        output << dropped << " events were dropped because a thread's buffer was full\n";
+    }
+}
\ No newline at end of file
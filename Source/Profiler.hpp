@@ -0,0 +1,135 @@
+#ifndef PROFILER_HEADER
+#define PROFILER_HEADER
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// times the enclosing scope under name, which must be a string literal
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCATENATE(profileScope, __LINE__)(name)
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_EXPANDED(a, b)
+#define PROFILE_CONCATENATE_EXPANDED(a, b) a##b
+
+// records how long each stage takes on each thread, so slow renders can be broken down
+// while disabled, a scope only checks one flag, so it can be left in hot code
+// every thread records into its own buffer without locking, and events are dropped once it is full
+// a thread allocates its buffer under a lock the first time it records anything, except inside a RealtimeScope,
+// where it takes a buffer reserved beforehand, or records nothing if there is none left
+class Profiler
+{
+public:
+    // events kept per thread until the profile is cleared
+    static const std::size_t MAX_EVENTS_PER_THREAD = 1 << 16;
+
+    // buffers that can be reserved for real-time threads at once
+    static const std::size_t MAX_REALTIME_BUFFERS = 4;
+
+    struct Event
+    {
+        const char* name;
+        uint32_t threadId;
+
+        // nanoseconds on the steady clock
+        int64_t start;
+        int64_t duration;
+
+        // counters are recorded as events with no duration
+        bool isCounter;
+        int64_t value;
+    };
+
+    class Scope
+    {
+    public:
+        Scope(const char* name);
+        ~Scope();
+
+    private:
+        const char* name;
+        int64_t start;
+        bool active;
+    };
+
+    // marks the calling thread as real-time (e.g. the audio thread) while it exists,
+    // so the scopes inside it never lock or allocate
+    class RealtimeScope
+    {
+    public:
+        RealtimeScope();
+        ~RealtimeScope();
+
+    private:
+        bool wasRealtime;
+    };
+
+    static void setEnabled(bool shouldBeEnabled);
+
+    // not real-time safe, allocates buffers until count of them are waiting for real-time threads
+    // a buffer is kept by the first real-time thread that records anything, for as long as the thread exists
+    static void reserveRealtimeBuffers(std::size_t count);
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // adds value to the counter at the current time
+    static void count(const char* name, int64_t value);
+
+    // drops every event recorded so far
+    static void clear();
+
+    // the following should only be called once the work being profiled has finished
+    // events of each thread are in the order their scopes ended
+    static std::vector<Event> getEvents();
+    static uint64_t getNumDroppedEvents();
+
+    // Chrome trace event format, which also opens in Perfetto
+    // https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+    static void writeChromeTrace(const std::string& filename);
+
+    // total and self time of each scope, where self time leaves out the scopes nested inside it
+    static void writeSummary(std::ostream& output);
+
+private:
+    // states of a buffer, which make emptying it and copying it exclusive
+    static const int IDLE = 0;
+    static const int READING = 1;
+    static const int EMPTYING = 2;
+
+    struct ThreadBuffer
+    {
+        std::vector<Event> events;
+        std::atomic<std::size_t> size{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<uint64_t> epoch{ 0 };
+        uint32_t threadId = 0;
+
+        // the owner never waits: it only empties the buffer if nothing is reading it,
+        // while a reader waits for an emptying to finish
+        std::atomic<int> state{ IDLE };
+    };
+
+    static std::atomic<bool> enabled;
+
+    // clearing moves the epoch, and each thread empties its own buffer when it sees the change
+    static std::atomic<uint64_t> epoch;
+
+    // events that were lost without a buffer to count them in since the last clear
+    static std::atomic<uint64_t> numLostEvents;
+
+    static std::mutex buffersMutex;
+    static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    // buffers waiting to be taken by real-time threads, without locking
+    static std::atomic<ThreadBuffer*> realtimeBuffers[MAX_REALTIME_BUFFERS];
+    static thread_local bool onRealtimeThread;
+
+    static int64_t now();
+    static void record(const Event& event);
+    static ThreadBuffer* createBuffer();
+    static void beginReading(ThreadBuffer& buffer);
+    static void endReading(ThreadBuffer& buffer);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "RealtimeMonitor.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#if WINDIGO_AUDIO_THREAD_HOOKS && JUCE_LINUX
+#include <dlfcn.h>
+#include <pthread.h>
+#endif
+
+thread_local bool RealtimeMonitor::onAudioThread = false;
+thread_local uint64_t RealtimeMonitor::threadAllocations = 0;
+thread_local uint64_t RealtimeMonitor::threadLocks = 0;
+
+bool RealtimeMonitor::isCountingAllocations()
+{
+#if WINDIGO_AUDIO_THREAD_HOOKS
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool RealtimeMonitor::isCountingLocks()
+{
+#if WINDIGO_AUDIO_THREAD_HOOKS && JUCE_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RealtimeMonitor::prepare(double sampleRate)
+{
+    this->sampleRate = sampleRate;
+}
+
+void RealtimeMonitor::setEnabled(bool shouldBeEnabled)
+{
+    enabled = shouldBeEnabled;
+}
+
+bool RealtimeMonitor::isEnabled() const
+{
+    return enabled;
+}
+
+void RealtimeMonitor::reset()
+{
+    resetRequested = true;
+}
+
+void RealtimeMonitor::clear()
+{
+    for (auto& bin : loadBins)
+    {
+        bin.store(0, std::memory_order_relaxed);
+    }
+    numBlocks.store(0, std::memory_order_relaxed);
+    numOverruns.store(0, std::memory_order_relaxed);
+    numAllocations.store(0, std::memory_order_relaxed);
+    numLocks.store(0, std::memory_order_relaxed);
+    numBlocksWithAllocations.store(0, std::memory_order_relaxed);
+    worstLoad.store(0.0, std::memory_order_relaxed);
+}
+
+RealtimeMonitor::Snapshot RealtimeMonitor::getSnapshot() const
+{
+    // the counts can be a block apart from each other, which is fine for display
+    Snapshot snapshot;
+    for (int i = 0; i < NUM_LOAD_BINS; i++)
+    {
+        snapshot.loadBins[i] = loadBins[i].load(std::memory_order_relaxed);
+    }
+    snapshot.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    snapshot.numOverruns = numOverruns.load(std::memory_order_relaxed);
+    snapshot.numAllocations = numAllocations.load(std::memory_order_relaxed);
+    snapshot.numLocks = numLocks.load(std::memory_order_relaxed);
+    snapshot.numBlocksWithAllocations = numBlocksWithAllocations.load(std::memory_order_relaxed);
+    snapshot.worstLoad = worstLoad.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+double RealtimeMonitor::Snapshot::getLoadPercentile(double fraction) const
+{
+    uint64_t total = 0;
+    for (uint64_t count : loadBins)
+    {
+        total += count;
+    }
+
+    // the upper edge of the bin that the percentile falls in
+    uint64_t below = 0;
+    for (int i = 0; i < NUM_LOAD_BINS - 1; i++)
+    {
+        below += loadBins[i];
+        if (below >= fraction * total)
+        {
+            return (i + 1) * LOAD_BIN_PERCENT / 100.0;
+        }
+    }
+    return worstLoad;
+}
+
+RealtimeMonitor::BlockScope::BlockScope(RealtimeMonitor& monitor, int numSamples)
+    : monitor(monitor), numSamples(numSamples), active(monitor.enabled && monitor.sampleRate > 0.0)
+{
+    if (!active)
+    {
+        return;
+    }
+    if (monitor.resetRequested.exchange(false))
+    {
+        monitor.clear();
+    }
+    threadAllocations = 0;
+    threadLocks = 0;
+    onAudioThread = true;
+    start = juce::Time::getHighResolutionTicks();
+}
+
+RealtimeMonitor::BlockScope::~BlockScope()
+{
+    if (!active)
+    {
+        return;
+    }
+    juce::int64 end = juce::Time::getHighResolutionTicks();
+    onAudioThread = false;
+
+    // only this thread writes, so a load and a store are enough for the running values
+    double seconds = juce::Time::highResolutionTicksToSeconds(end - start);
+    double load = seconds * monitor.sampleRate / juce::jmax(1, numSamples);
+    int bin = juce::jmin(NUM_LOAD_BINS - 1, (int) (load * 100.0 / LOAD_BIN_PERCENT));
+    monitor.loadBins[bin].fetch_add(1, std::memory_order_relaxed);
+    monitor.numBlocks.fetch_add(1, std::memory_order_relaxed);
+    if (load > 1.0)
+    {
+        monitor.numOverruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (load > monitor.worstLoad.load(std::memory_order_relaxed))
+    {
+        monitor.worstLoad.store(load, std::memory_order_relaxed);
+    }
+    if (threadAllocations > 0)
+    {
+        monitor.numAllocations.fetch_add(threadAllocations, std::memory_order_relaxed);
+        monitor.numBlocksWithAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    monitor.numLocks.fetch_add(threadLocks, std::memory_order_relaxed);
+}
+
+void RealtimeMonitor::countAllocation()
+{
+    if (onAudioThread)
+    {
+        threadAllocations++;
+    }
+}
+
+void RealtimeMonitor::countLock()
+{
+    if (onAudioThread)
+    {
+        threadLocks++;
+    }
+}
+
+#if WINDIGO_AUDIO_THREAD_HOOKS
+// freeing on the audio thread can take the allocator's lock as well, so it counts as an allocation
+void* operator new(std::size_t size)
+{
+    RealtimeMonitor::countAllocation();
+    if (void* pointer = std::malloc(std::max<std::size_t>(size, 1)))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeMonitor::countAllocation();
+    return std::malloc(std::max<std::size_t>(size, 1));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+    {
+        RealtimeMonitor::countAllocation();
+        std::free(pointer);
+    }
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    operator delete(pointer);
+}
+
+#if JUCE_LINUX
+// juce::CriticalSection and std::mutex both lock through this
+// the real function is looked up without a function-local static, whose guard could lock
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    using LockFunction = int (*)(pthread_mutex_t*);
+    static std::atomic<LockFunction> next{ nullptr };
+    LockFunction function = next.load(std::memory_order_acquire);
+    if (function == nullptr)
+    {
+        function = (LockFunction) dlsym(RTLD_NEXT, "pthread_mutex_lock");
+        next.store(function, std::memory_order_release);
+    }
+    RealtimeMonitor::countLock();
+    return function(mutex);
+}
+#endif
+#endif
\ No newline at end of file
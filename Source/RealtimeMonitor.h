@@ -0,0 +1,107 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <cstdint>
+
+// replaces the global operator new/delete, and pthread_mutex_lock on Linux,
+// so that heap and lock calls made on the audio thread can be counted
+#ifndef WINDIGO_AUDIO_THREAD_HOOKS
+#define WINDIGO_AUDIO_THREAD_HOOKS 0
+#endif
+
+//==============================================================================
+/**
+    Measures how much of each block's deadline processBlock uses, and counts the
+    heap allocations and lock acquisitions it makes.
+
+    The deadline of a block is its own duration at the host's sample rate. Block times
+    go into a histogram of the share of the deadline they used, and blocks that took
+    longer than their deadline are counted as overruns, since the host can only be later.
+
+    Everything is kept in atomics that only the audio thread writes, so the editor can
+    read a snapshot at any time without locking and without stalling the audio thread.
+
+    The hooks are only compiled in with WINDIGO_AUDIO_THREAD_HOOKS. Operator new/delete
+    are replaced for the plugin's own module, which on Linux also needs the module to be
+    linked with -Bsymbolic-functions. Locks are only counted on Linux.
+*/
+class RealtimeMonitor
+{
+public:
+  // each bin covers this share of the deadline, and the last bin holds every block over it
+  static const int LOAD_BIN_PERCENT = 10;
+  static const int NUM_LOAD_BINS = 21;
+
+  struct Snapshot
+  {
+    uint64_t loadBins[NUM_LOAD_BINS] = {};
+    uint64_t numBlocks = 0;
+    uint64_t numOverruns = 0;
+    uint64_t numAllocations = 0;
+    uint64_t numLocks = 0;
+    uint64_t numBlocksWithAllocations = 0;
+
+    // fractions of the deadline
+    double worstLoad = 0.0;
+
+    // the load that this fraction of the blocks stayed under, to the resolution of the bins
+    double getLoadPercentile(double fraction) const;
+  };
+
+  // whether the hooks were compiled in, the counts stay at 0 otherwise
+  static bool isCountingAllocations();
+  static bool isCountingLocks();
+
+  // not real-time safe, called from prepareToPlay
+  void prepare(double sampleRate);
+
+  void setEnabled(bool shouldBeEnabled);
+  bool isEnabled() const;
+
+  // the audio thread clears everything at the start of its next block
+  void reset();
+
+  Snapshot getSnapshot() const;
+
+  // measures one processBlock, and counts what the hooks see on this thread while it exists
+  class BlockScope
+  {
+  public:
+    BlockScope(RealtimeMonitor& monitor, int numSamples);
+    ~BlockScope();
+
+  private:
+    RealtimeMonitor& monitor;
+    int numSamples;
+    bool active;
+    juce::int64 start = 0;
+  };
+
+  // called by the hooks on any thread, these only count on a thread inside a BlockScope
+  static void countAllocation();
+  static void countLock();
+
+private:
+  std::atomic<bool> enabled{ false };
+  std::atomic<bool> resetRequested{ false };
+  double sampleRate = 0.0;
+
+  std::atomic<uint64_t> loadBins[NUM_LOAD_BINS] = {};
+  std::atomic<uint64_t> numBlocks{ 0 };
+  std::atomic<uint64_t> numOverruns{ 0 };
+  std::atomic<uint64_t> numAllocations{ 0 };
+  std::atomic<uint64_t> numLocks{ 0 };
+  std::atomic<uint64_t> numBlocksWithAllocations{ 0 };
+  std::atomic<double> worstLoad{ 0.0 };
+
+  // counts of the thread that is inside a BlockScope, if any
+  static thread_local bool onAudioThread;
+  static thread_local uint64_t threadAllocations;
+  static thread_local uint64_t threadLocks;
+
+  void clear();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeMonitor)
+};
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "RealtimeMonitorView.h"
+
+RealtimeMonitorView::RealtimeMonitorView(const RealtimeMonitor& monitor)
+    : monitor(monitor)
+{
+    setOpaque(true);
+    startTimerHz(REFRESH_RATE_HZ);
+}
+
+RealtimeMonitorView::~RealtimeMonitorView()
+{
+    stopTimer();
+}
+
+void RealtimeMonitorView::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+    juce::Rectangle<int> bounds = getLocalBounds();
+    juce::Rectangle<int> text = bounds.removeFromLeft(getWidth() / 2);
+
+    juce::String load = "No blocks measured";
+    if (snapshot.numBlocks > 0)
+    {
+        load = "Load: median " + juce::String(juce::roundToInt(snapshot.getLoadPercentile(0.5) * 100.0))
+            + "%, 99th " + juce::String(juce::roundToInt(snapshot.getLoadPercentile(0.99) * 100.0))
+            + "%, worst " + juce::String(juce::roundToInt(snapshot.worstLoad * 100.0))
+            + "%, overruns " + juce::String((juce::int64) snapshot.numOverruns);
+    }
+    juce::String calls = "Allocations: " + (RealtimeMonitor::isCountingAllocations()
+        ? juce::String((juce::int64) snapshot.numAllocations) + " in " + juce::String((juce::int64) snapshot.numBlocksWithAllocations) + " blocks"
+        : juce::String("not counted"));
+    calls += ", locks: " + (RealtimeMonitor::isCountingLocks()
+        ? juce::String((juce::int64) snapshot.numLocks)
+        : juce::String("not counted"));
+
+    g.setColour(snapshot.numOverruns > 0 ? juce::Colours::orange : juce::Colours::white);
+    g.drawText(load, text.removeFromTop(getHeight() / 2), juce::Justification::centredLeft, true);
+    g.setColour(juce::Colours::white);
+    g.drawText(calls, text, juce::Justification::centredLeft, true);
+
+    // bars are scaled to the fullest bin, and the bins past the deadline are drawn in red
+    uint64_t fullest = 1;
+    for (uint64_t count : snapshot.loadBins)
+    {
+        fullest = juce::jmax(fullest, count);
+    }
+    float binWidth = bounds.getWidth() / (float) RealtimeMonitor::NUM_LOAD_BINS;
+    int deadlineBin = 100 / RealtimeMonitor::LOAD_BIN_PERCENT;
+    for (int i = 0; i < RealtimeMonitor::NUM_LOAD_BINS; i++)
+    {
+        float height = bounds.getHeight() * (float) snapshot.loadBins[i] / fullest;
+        g.setColour(i < deadlineBin ? juce::Colours::skyblue : juce::Colours::red);
+        g.fillRect(bounds.getX() + i * binWidth, bounds.getBottom() - height, binWidth - 1.0f, height);
+    }
+}
+
+void RealtimeMonitorView::timerCallback()
+{
+    snapshot = monitor.getSnapshot();
+    repaint();
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "RealtimeMonitor.h"
+
+//==============================================================================
+/**
+    Shows what the RealtimeMonitor has measured so far: the histogram of block loads
+    on the right, with the share of the deadline on the horizontal axis, and the load
+    percentiles, overruns, allocations and locks as text on the left.
+
+    The monitor is read lock-free from a timer, a few times a second.
+*/
+class RealtimeMonitorView : public juce::Component, private juce::Timer
+{
+public:
+  static const int REFRESH_RATE_HZ = 4;
+
+  RealtimeMonitorView(const RealtimeMonitor& monitor);
+  ~RealtimeMonitorView() override;
+
+  void paint(juce::Graphics& g) override;
+
+private:
+  const RealtimeMonitor& monitor;
+  RealtimeMonitor::Snapshot snapshot;
+
+  void timerCallback() override;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeMonitorView)
+};
\ No newline at end of file
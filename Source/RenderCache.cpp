@@ -0,0 +1,350 @@
+#include "RenderCache.hpp"
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// a render file is a header followed by every channel's samples one after the other,
+// as doubles in the machine's own byte order, so they can be used straight from the mapping
+// the cache is only ever read by the machine that wrote it
+//
+// 0:  Magic (WRND)
+// 4:  Version
+// 8:  NumChannels
+// 12: SampleRate
+// 16: NumSamples
+// 24: Key
+// 32: unused up to HEADER_SIZE
+static const char MAGIC[4] = { 'W', 'R', 'N', 'D' };
+static const char* RENDER_EXTENSION = ".render";
+static const char* TEMPORARY_EXTENSION = ".tmp";
+
+// temporary files left behind by a process that was killed while storing are deleted after this long
+static const auto ABANDONED_AGE = std::chrono::hours(1);
+
+// 64-bit FNV-1a, one word at a time instead of one byte at a time
+// the high bits are folded back in after each word, so they reach the low bits of the hash too
+static const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+static const uint64_t FNV_PRIME = 0x100000001b3ull;
+
+static uint64_t hashWord(uint64_t hash, uint64_t word)
+{
+    hash = (hash ^ word) * FNV_PRIME;
+    return hash ^ (hash >> 32);
+}
+
+RenderCache::Render::~Render()
+{
+#ifdef _WIN32
+    if (mapping != nullptr)
+    {
+        UnmapViewOfFile(mapping);
+    }
+    if (fileMapping != nullptr)
+    {
+        CloseHandle(fileMapping);
+    }
+    if (file != nullptr)
+    {
+        CloseHandle(file);
+    }
+#else
+    if (mapping != nullptr)
+    {
+        munmap(const_cast<char*>(mapping), mappingSize);
+    }
+#endif
+}
+
+const double* RenderCache::Render::getChannel(std::size_t channel) const
+{
+    return reinterpret_cast<const double*>(mapping + HEADER_SIZE) + channel * numSamples;
+}
+
+uint32_t RenderCache::Render::getNumChannels() const
+{
+    return numChannels;
+}
+
+uint64_t RenderCache::Render::getNumSamples() const
+{
+    return numSamples;
+}
+
+uint32_t RenderCache::Render::getSampleRate() const
+{
+    return sampleRate;
+}
+
+RenderCache::RenderCache(std::string directory, uint64_t maxSize)
+    : directory(directory), maxSize(maxSize)
+{
+}
+
+std::string RenderCache::getDefaultDirectory()
+{
+#ifdef _WIN32
+    const char* localAppData = std::getenv("LOCALAPPDATA");
+    return std::string(localAppData != nullptr ? localAppData : ".") + "\\Windigo\\RenderCache";
+#elif defined(__APPLE__)
+    const char* home = std::getenv("HOME");
+    return std::string(home != nullptr ? home : ".") + "/Library/Caches/Windigo";
+#else
+    // https://specifications.freedesktop.org/basedir-spec/latest/
+    const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+    if (cacheHome != nullptr && cacheHome[0] != '\0')
+    {
+        return std::string(cacheHome) + "/windigo";
+    }
+    const char* home = std::getenv("HOME");
+    return std::string(home != nullptr ? home : ".") + "/.cache/windigo";
+#endif
+}
+
+const std::string& RenderCache::getDirectory() const
+{
+    return directory;
+}
+
+uint64_t RenderCache::hashAudio(const SampleBuffer& samples, uint32_t sampleRate)
+{
+    PROFILE_SCOPE("hash");
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = hashWord(hash, sampleRate);
+    hash = hashWord(hash, samples.getNumChannels());
+    hash = hashWord(hash, samples.getNumSamples());
+    for (std::size_t channel = 0; channel < samples.getNumChannels(); channel++)
+    {
+        const double* source = samples.getChannel(channel);
+        for (std::size_t i = 0; i < samples.getNumSamples(); i++)
+        {
+            uint64_t word;
+            std::memcpy(&word, &source[i], sizeof(double));
+            hash = hashWord(hash, word);
+        }
+    }
+    return hash;
+}
+
+std::string RenderCache::getKey(uint64_t audioHash, const PitchShifter& shifter, int steps)
+{
+    uint64_t hash = hashWord(FNV_OFFSET_BASIS, audioHash);
+    hash = hashWord(hash, VERSION);
+    hash = hashWord(hash, (uint64_t) shifter.getFrameSize());
+    hash = hashWord(hash, (uint64_t) shifter.getOverlapFactor());
+    hash = hashWord(hash, (uint64_t) (int64_t) steps);
+
+    static const char digits[] = "0123456789abcdef";
+    std::string key(16, '0');
+    for (int i = 15; i >= 0; i--)
+    {
+        key[i] = digits[hash & 0xf];
+        hash >>= 4;
+    }
+    return key;
+}
+
+std::string RenderCache::getPath(const std::string& key) const
+{
+    return (fs::path(directory) / (key + RENDER_EXTENSION)).string();
+}
+
+std::shared_ptr<const RenderCache::Render> RenderCache::load(const std::string& key) const
+{
+    PROFILE_SCOPE("cache lookup");
+    std::string path = getPath(key);
+    std::shared_ptr<Render> render(new Render());
+
+    // the file is mapped read only, and it is never modified once it has its final name
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+    render->file = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || (uint64_t) size.QuadPart < HEADER_SIZE)
+    {
+        return nullptr;
+    }
+    render->fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (render->fileMapping == nullptr)
+    {
+        return nullptr;
+    }
+    render->mapping = static_cast<const char*>(MapViewOfFile(render->fileMapping, FILE_MAP_READ, 0, 0, 0));
+    if (render->mapping == nullptr)
+    {
+        return nullptr;
+    }
+    render->mappingSize = (std::size_t) size.QuadPart;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return nullptr;
+    }
+    struct stat status;
+    bool mapped = false;
+    if (fstat(file, &status) == 0 && (uint64_t) status.st_size >= HEADER_SIZE)
+    {
+        void* mapping = mmap(nullptr, (std::size_t) status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            render->mapping = static_cast<const char*>(mapping);
+            render->mappingSize = (std::size_t) status.st_size;
+            mapped = true;
+        }
+    }
+    // the mapping stays valid after the file is closed (and even after it is deleted)
+    close(file);
+    if (!mapped)
+    {
+        return nullptr;
+    }
+#endif
+
+    // a file that doesn't match its name is treated as missing, and replaced by the next store
+    uint32_t version;
+    uint64_t storedKey;
+    std::memcpy(&version, render->mapping + 4, 4);
+    std::memcpy(&render->numChannels, render->mapping + 8, 4);
+    std::memcpy(&render->sampleRate, render->mapping + 12, 4);
+    std::memcpy(&render->numSamples, render->mapping + 16, 8);
+    std::memcpy(&storedKey, render->mapping + 24, 8);
+    // the sizes are compared by division, so a corrupt header can't overflow them
+    uint64_t dataSize = render->mappingSize - HEADER_SIZE;
+    uint64_t numValues = dataSize / sizeof(double);
+    if (std::memcmp(render->mapping, MAGIC, 4) != 0 || version != VERSION
+        || storedKey != std::stoull(key, nullptr, 16)
+        || render->numChannels == 0 || dataSize % sizeof(double) != 0
+        || numValues % render->numChannels != 0 || numValues / render->numChannels != render->numSamples)
+    {
+        return nullptr;
+    }
+
+    // the modification time orders renders for eviction, so using a render makes it the newest
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    return render;
+}
+
+void RenderCache::store(const std::string& key, const SampleBuffer& samples, uint32_t sampleRate) const
+{
+    PROFILE_SCOPE("cache store");
+    std::error_code error;
+    fs::create_directories(directory, error);
+
+    // every writer has its own temporary file, so writers of the same key never see each other's half written file
+    // and readers only ever open the final name, which is replaced in one step by the rename
+    std::random_device random;
+    std::string suffix = std::to_string(((uint64_t) random() << 32) | random());
+    fs::path temporaryPath = fs::path(directory) / (key + "." + suffix + TEMPORARY_EXTENSION);
+    {
+        std::ofstream output(temporaryPath, std::ios_base::binary);
+        char header[HEADER_SIZE] = {};
+        uint32_t numChannels = (uint32_t) samples.getNumChannels();
+        uint64_t numSamples = samples.getNumSamples();
+        uint64_t storedKey = std::stoull(key, nullptr, 16);
+        std::memcpy(header, MAGIC, 4);
+        std::memcpy(header + 4, &VERSION, 4);
+        std::memcpy(header + 8, &numChannels, 4);
+        std::memcpy(header + 12, &sampleRate, 4);
+        std::memcpy(header + 16, &numSamples, 8);
+        std::memcpy(header + 24, &storedKey, 8);
+        output.write(header, HEADER_SIZE);
+        for (uint32_t channel = 0; channel < numChannels; channel++)
+        {
+            output.write(reinterpret_cast<const char*>(samples.getChannel(channel)), numSamples * sizeof(double));
+        }
+        output.close();
+        if (!output)
+        {
+            fs::remove(temporaryPath, error);
+            return;
+        }
+    }
+
+    // if the render can't be replaced (e.g. it is open on windows), the one that is already there is kept
+    fs::rename(temporaryPath, getPath(key), error);
+    if (error)
+    {
+        fs::remove(temporaryPath, error);
+        return;
+    }
+    evict();
+}
+
+void RenderCache::evict() const
+{
+    struct Entry
+    {
+        fs::path path;
+        fs::file_time_type time;
+        uint64_t size;
+    };
+
+    // other processes can add or delete files at the same time, so every error just skips that file
+    std::error_code error;
+    std::vector<Entry> entries;
+    uint64_t totalSize = 0;
+    auto now = fs::file_time_type::clock::now();
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+    {
+        std::error_code entryError;
+        fs::path path = it->path();
+        fs::file_time_type time = fs::last_write_time(path, entryError);
+        uint64_t size = fs::file_size(path, entryError);
+        if (entryError)
+        {
+            continue;
+        }
+        if (path.extension() == TEMPORARY_EXTENSION && now - time > ABANDONED_AGE)
+        {
+            fs::remove(path, entryError);
+        }
+        else if (path.extension() == RENDER_EXTENSION)
+        {
+            entries.push_back({ path, time, size });
+            totalSize += size;
+        }
+    }
+
+    // least recently used first
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (const Entry& entry : entries)
+    {
+        if (totalSize <= maxSize)
+        {
+            break;
+        }
+        // a render that is still mapped stays readable by whoever mapped it
+        std::error_code entryError;
+        if (fs::remove(entry.path, entryError))
+        {
+            totalSize -= entry.size;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef RENDERCACHE_HEADER
+#define RENDERCACHE_HEADER
+
+#include "PitchShifter.hpp"
+#include "SampleBuffer.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// keeps shifted renders on disk, so shifting the same audio by the same steps with the same shifter
+// only costs mapping the file the next time, in this process or any other one
+// renders are named after a hash of the source samples, the steps and the shifter's parameters,
+// so every process that uses the same directory shares them without any index to keep in sync
+// renders are written to a temporary file and renamed into place, so a render is either complete or missing,
+// and the least recently used renders are deleted once the directory grows past its size limit
+class RenderCache
+{
+public:
+    // bumped whenever the file layout or the shifter's output changes, so old renders are never used
+    static const uint32_t VERSION = 1;
+
+    // size of the header before the samples, which keeps the samples aligned in the mapped file
+    static const std::size_t HEADER_SIZE = 64;
+
+    static const uint64_t DEFAULT_MAX_SIZE = 1ull << 30;
+
+    // a render mapped into memory, which stays valid as long as it is referenced,
+    // even if the file is evicted in the meantime
+    class Render
+    {
+    public:
+        ~Render();
+
+        const double* getChannel(std::size_t channel) const;
+        uint32_t getNumChannels() const;
+        uint64_t getNumSamples() const;
+        uint32_t getSampleRate() const;
+
+    private:
+        friend class RenderCache;
+        Render() = default;
+
+        const char* mapping = nullptr;
+        std::size_t mappingSize = 0;
+#ifdef _WIN32
+        void* file = nullptr;
+        void* fileMapping = nullptr;
+#endif
+
+        uint32_t numChannels = 0;
+        uint32_t sampleRate = 0;
+        uint64_t numSamples = 0;
+    };
+
+    // renders that would make the directory larger than maxSize bytes evict the oldest ones
+    RenderCache(std::string directory, uint64_t maxSize = DEFAULT_MAX_SIZE);
+
+    // the user's cache directory (e.g. ~/.cache/windigo), which the plugin and the demo share by default
+    static std::string getDefaultDirectory();
+
+    // hashes every sample along with the rate and the layout
+    static uint64_t hashAudio(const SampleBuffer& samples, uint32_t sampleRate);
+
+    // the name of a render of the hashed audio by steps with shifter
+    static std::string getKey(uint64_t audioHash, const PitchShifter& shifter, int steps);
+
+    // returns nullptr if there is no complete render for key
+    std::shared_ptr<const Render> load(const std::string& key) const;
+
+    // safe to call from several threads and processes at once, the last complete render wins
+    // errors (e.g. a full disk) are ignored, since the render can always be shifted again
+    void store(const std::string& key, const SampleBuffer& samples, uint32_t sampleRate) const;
+
+    const std::string& getDirectory() const;
+
+private:
+    std::string directory;
+    uint64_t maxSize;
+
+    std::string getPath(const std::string& key) const;
+    void evict() const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "RepitchScheduler.h"
+
+RepitchScheduler::RepitchScheduler(RenderFunction render)
+    : Thread("Repitch"), render(std::move(render))
+{
+    startThread();
+}
+
+RepitchScheduler::~RepitchScheduler()
+{
+    // the render in progress notices threadShouldExit at its next frame
+    signalThreadShouldExit();
+    wakeUp.signal();
+    stopThread(10000);
+}
+
+void RepitchScheduler::request(int pitch)
+{
+    // the pitch is stored before pending is set, so the thread never misses the latest one
+    requestedPitch = pitch;
+    pending = true;
+    wakeUp.signal();
+}
+
+void RepitchScheduler::restart(int pitch)
+{
+    generation++;
+    request(pitch);
+}
+
+void RepitchScheduler::run()
+{
+    while (!threadShouldExit())
+    {
+        wakeUp.wait(-1);
+
+        // any number of requests made since the last wake up are handled as one
+        while (pending.exchange(false) && !threadShouldExit())
+        {
+            int pitch = requestedPitch;
+            int renderGeneration = generation;
+            if (pitch == renderedPitch && renderGeneration == renderedGeneration)
+            {
+                // e.g. up then down before the first render finished, the sound is already at this pitch
+                if (onFinished)
+                {
+                    onFinished(pitch);
+                }
+                continue;
+            }
+
+            // a newer request sets pending again, so it is picked up by the loop after cancelling
+            auto checkProgress = [&](double progress)
+                {
+                    if (threadShouldExit() || requestedPitch != pitch || generation != renderGeneration)
+                    {
+                        return false;
+                    }
+                    if (onProgress)
+                    {
+                        onProgress(pitch, progress);
+                    }
+                    return true;
+                };
+
+            if (render(pitch, checkProgress))
+            {
+                renderedPitch = pitch;
+                renderedGeneration = renderGeneration;
+                if (onFinished)
+                {
+                    onFinished(pitch);
+                }
+            }
+            else
+            {
+                // a cancelled render may already have published its start, so the sound is no longer
+                // known to be at renderedPitch, and the next request is rendered even if it is for that pitch
+                renderedGeneration = -1;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <functional>
+
+//==============================================================================
+/**
+    Runs re-pitch renders on one background thread, one at a time.
+
+    Requests that arrive while a render is running are coalesced, so only the latest
+    target pitch is rendered next. A render is cancelled between frames as soon as it
+    is no longer the latest request, so clicking up five semitones costs one render.
+*/
+class RepitchScheduler : private juce::Thread
+{
+public:
+  // called with the fraction of the render that is done
+  // returns false if the render should stop
+  using ProgressFunction = std::function<bool(double)>;
+
+  // renders the sound for a pitch, returns false if it was cancelled
+  using RenderFunction = std::function<bool(int pitch, const ProgressFunction& onProgress)>;
+
+  RepitchScheduler(RenderFunction render);
+  ~RepitchScheduler() override;
+
+  // renders the pitch unless it is the last one that was rendered, and no render was cancelled since
+  void request(int pitch);
+
+  // renders the pitch even if it was already rendered, e.g. after a new clip is loaded
+  void restart(int pitch);
+
+  // called from the background thread, so they must be set before the first request
+  std::function<void(int pitch, double progress)> onProgress;
+  std::function<void(int pitch)> onFinished;
+
+private:
+  RenderFunction render;
+  juce::WaitableEvent wakeUp;
+
+  // written by request/restart, read by the background thread
+  std::atomic<int> requestedPitch{ 0 };
+  std::atomic<int> generation{ 0 };
+  std::atomic<bool> pending{ false };
+
+  // only used by the background thread
+  int renderedPitch = 0;
+  int renderedGeneration = -1;
+
+  void run() override;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RepitchScheduler)
+};
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "SampleBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+SampleBuffer::SampleBuffer() : block(nullptr), numChannels(0), numSamples(0), stride(0)
+{
+}
+
+SampleBuffer::SampleBuffer(std::size_t numChannels, std::size_t numSamples)
+    : block(nullptr), numChannels(numChannels), numSamples(numSamples)
+{
+    // round the stride up to a multiple of the alignment
+    // so that every channel starts on an aligned address
+    std::size_t samplesPerLine = ALIGNMENT / sizeof(double);
+    stride = (numSamples + samplesPerLine - 1) / samplesPerLine * samplesPerLine;
+    allocate();
+}
+
+SampleBuffer::SampleBuffer(const SampleBuffer& other)
+    : block(nullptr), numChannels(other.numChannels), numSamples(other.numSamples), stride(other.stride)
+{
+    allocate();
+    if (block != nullptr)
+    {
+        std::memcpy(block, other.block, getSizeInBytes());
+    }
+}
+
+SampleBuffer::SampleBuffer(SampleBuffer&& other) noexcept
+    : block(other.block), numChannels(other.numChannels), numSamples(other.numSamples), stride(other.stride)
+{
+    // the block is handed off without copying
+    other.block = nullptr;
+    other.numChannels = 0;
+    other.numSamples = 0;
+    other.stride = 0;
+}
+
+SampleBuffer& SampleBuffer::operator=(const SampleBuffer& other)
+{
+    if (this != &other)
+    {
+        SampleBuffer copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+SampleBuffer& SampleBuffer::operator=(SampleBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        std::swap(block, other.block);
+        std::swap(numChannels, other.numChannels);
+        std::swap(numSamples, other.numSamples);
+        std::swap(stride, other.stride);
+    }
+    return *this;
+}
+
+SampleBuffer::~SampleBuffer()
+{
+    release();
+}
+
+void SampleBuffer::allocate()
+{
+    std::size_t size = getSizeInBytes();
+    if (size == 0)
+    {
+        block = nullptr;
+        return;
+    }
+
+    // zero initialised like std::vector<double>
+    block = static_cast<double*>(::operator new(size, std::align_val_t(ALIGNMENT)));
+    std::fill(block, block + numChannels * stride, 0.0);
+}
+
+void SampleBuffer::release()
+{
+    if (block != nullptr)
+    {
+        ::operator delete(block, std::align_val_t(ALIGNMENT));
+        block = nullptr;
+    }
+    numChannels = 0;
+    numSamples = 0;
+    stride = 0;
+}
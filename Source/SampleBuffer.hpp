@@ -0,0 +1,101 @@
+#ifndef SAMPLEBUFFER_HEADER
+#define SAMPLEBUFFER_HEADER
+
+#include <cstddef>
+#include <cstdint>
+
+class SampleBuffer
+{
+public:
+    // every channel starts on a 64-byte boundary (the size of a cache line),
+    // so kernels can use aligned vector loads on any channel
+    static const std::size_t ALIGNMENT = 64;
+
+    // cheap non-owning view of one channel
+    template <typename T>
+    class ChannelView
+    {
+    public:
+        ChannelView(T* data, std::size_t size) : pointer(data), length(size) {}
+
+        T& operator[](std::size_t index) const { return pointer[index]; }
+        T* data() const { return pointer; }
+        std::size_t size() const { return length; }
+        T* begin() const { return pointer; }
+        T* end() const { return pointer + length; }
+
+    private:
+        T* pointer;
+        std::size_t length;
+    };
+
+    // non-owning view which indexes the planar data as (frame, channel)
+    template <typename T>
+    class InterleavedView
+    {
+    public:
+        InterleavedView(T* data, std::size_t numChannels, std::size_t numSamples, std::size_t stride)
+            : pointer(data), numChannels(numChannels), numSamples(numSamples), stride(stride) {}
+
+        T& operator()(std::size_t frame, std::size_t channel) const { return pointer[channel * stride + frame]; }
+        std::size_t getNumChannels() const { return numChannels; }
+        std::size_t getNumSamples() const { return numSamples; }
+
+    private:
+        T* pointer;
+        std::size_t numChannels;
+        std::size_t numSamples;
+        std::size_t stride;
+    };
+
+    SampleBuffer();
+    SampleBuffer(std::size_t numChannels, std::size_t numSamples);
+    SampleBuffer(const SampleBuffer& other);
+    SampleBuffer(SampleBuffer&& other) noexcept;
+    SampleBuffer& operator=(const SampleBuffer& other);
+    SampleBuffer& operator=(SampleBuffer&& other) noexcept;
+    ~SampleBuffer();
+
+    ChannelView<double> operator[](std::size_t channel) { return ChannelView<double>(getChannel(channel), numSamples); }
+    ChannelView<const double> operator[](std::size_t channel) const { return ChannelView<const double>(getChannel(channel), numSamples); }
+
+    double* getChannel(std::size_t channel) { return block + channel * stride; }
+    const double* getChannel(std::size_t channel) const { return block + channel * stride; }
+
+    InterleavedView<double> interleaved() { return InterleavedView<double>(block, numChannels, numSamples, stride); }
+    InterleavedView<const double> interleaved() const { return InterleavedView<const double>(block, numChannels, numSamples, stride); }
+
+    // copies frames [start, start + count) into an interleaved destination
+    template <typename T>
+    void copyInterleaved(T* destination, std::size_t start, std::size_t count) const
+    {
+        for (std::size_t channel = 0; channel < numChannels; channel++)
+        {
+            const double* source = getChannel(channel) + start;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                destination[i * numChannels + channel] = static_cast<T>(source[i]);
+            }
+        }
+    }
+
+    // the whole buffer is a single block of numChannels * stride samples
+    double* data() { return block; }
+    const double* data() const { return block; }
+    std::size_t getSizeInBytes() const { return numChannels * stride * sizeof(double); }
+
+    std::size_t getNumChannels() const { return numChannels; }
+    std::size_t getNumSamples() const { return numSamples; }
+    std::size_t getStride() const { return stride; }
+
+private:
+    double* block;
+    std::size_t numChannels;
+    std::size_t numSamples;
+    std::size_t stride;
+
+    void allocate();
+    void release();
+};
+
+#endif
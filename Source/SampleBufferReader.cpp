@@ -0,0 +1,39 @@
+#include "SampleBufferReader.h"
+
+SampleBufferReader::SampleBufferReader(const SampleBuffer& buffer, double sampleRate)
+    : AudioFormatReader(nullptr, "SampleBuffer"), buffer(buffer)
+{
+    this->sampleRate = sampleRate;
+    bitsPerSample = 32;
+    lengthInSamples = (juce::int64) buffer.getNumSamples();
+    numChannels = (unsigned int) buffer.getNumChannels();
+    usesFloatingPointData = true;
+}
+
+bool SampleBufferReader::readSamples(int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+    juce::int64 startSampleInFile, int numSamples)
+{
+    // with usesFloatingPointData, the destination channels hold floats
+    for (int channel = 0; channel < numDestChannels; channel++)
+    {
+        if (destChannels[channel] == nullptr)
+        {
+            continue;
+        }
+
+        float* destination = reinterpret_cast<float*>(destChannels[channel]) + startOffsetInDestBuffer;
+        if (channel >= (int) buffer.getNumChannels())
+        {
+            juce::FloatVectorOperations::clear(destination, numSamples);
+            continue;
+        }
+
+        const double* source = buffer.getChannel((std::size_t) channel);
+        for (int i = 0; i < numSamples; i++)
+        {
+            juce::int64 index = startSampleInFile + i;
+            destination[i] = index >= 0 && index < lengthInSamples ? (float) source[index] : 0.0f;
+        }
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "SampleBuffer.hpp"
+
+//==============================================================================
+/**
+    Presents shifted samples that are already in memory as a juce::AudioFormatReader,
+    so that a juce::SamplerSound can be built from them without writing a file first.
+
+    The samples are converted to float as they are read. The buffer must outlive the reader.
+*/
+class SampleBufferReader : public juce::AudioFormatReader
+{
+public:
+  SampleBufferReader(const SampleBuffer& buffer, double sampleRate);
+
+  bool readSamples(int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+    juce::int64 startSampleInFile, int numSamples) override;
+
+private:
+  const SampleBuffer& buffer;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleBufferReader)
+};
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "SampleStreamer.h"
+
+#include <algorithm>
+
+SampleStreamer::~SampleStreamer()
+{
+    reset();
+}
+
+void SampleStreamer::prepare(int ringLength)
+{
+    reset();
+    this->ringLength = std::max(READ_BLOCK_SIZE, ringLength);
+    ring.setSize(2, 2 * this->ringLength);
+    ring.clear();
+}
+
+void SampleStreamer::reset()
+{
+    // requests that were never picked up still count as users of their samples
+    while (requestFifo.getNumReady() > 0)
+    {
+        openNextRequest();
+    }
+    close();
+    readyGeneration = 0;
+    generation++;
+}
+
+int SampleStreamer::getMaxReadLength() const
+{
+    // the reader keeps the other half of the ring to fill while the voice reads
+    return ringLength / 2;
+}
+
+void SampleStreamer::start(ShiftedSample* sample)
+{
+    sample->numUsers++;
+    int start1, size1, start2, size2;
+    requestFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 == 0)
+    {
+        // the reader is too far behind, so this note stays silent
+        sample->numUsers--;
+        return;
+    }
+    requests[start1] = { sample, ++generation };
+    requestFifo.finishedWrite(1);
+}
+
+void SampleStreamer::stop()
+{
+    int start1, size1, start2, size2;
+    requestFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0)
+    {
+        requests[start1] = { nullptr, ++generation };
+        requestFifo.finishedWrite(1);
+    }
+}
+
+bool SampleStreamer::read(juce::int64 first, int count, const float* channels[2])
+{
+    jassert(count <= getMaxReadLength());
+    if (readyGeneration.load() != generation)
+    {
+        return false;
+    }
+
+    // the reader only overwrites frames before first, so it can keep going even if this read fails
+    consumed = first;
+    if (first + count > written.load())
+    {
+        return false;
+    }
+    int offset = (int) (first % ringLength);
+    channels[0] = ring.getReadPointer(0, offset);
+    channels[1] = ring.getReadPointer(1, offset);
+    return true;
+}
+
+int SampleStreamer::useTimeSlice()
+{
+    if (requestFifo.getNumReady() > 0)
+    {
+        // only the latest request matters, the ones before it were stopped before they were opened
+        while (requestFifo.getNumReady() > 0)
+        {
+            openNextRequest();
+        }
+        return 0;
+    }
+    if (current == nullptr)
+    {
+        return IDLE_INTERVAL_MS;
+    }
+
+    // after an underrun the voice can be ahead of the reader, the frames it skipped are not needed
+    juce::int64 first = consumed.load();
+    juce::int64 end = written.load();
+    if (first > end)
+    {
+        reader->seek((uint64_t) first);
+        end = first;
+        written = end;
+    }
+
+    // the file is followed by one zero frame, so the voice can interpolate up to its last frame
+    juce::int64 fileEnd = current->length + 1;
+    int numFrames = (int) std::min<juce::int64>({ READ_BLOCK_SIZE, first + ringLength - end, fileEnd - end });
+    if (numFrames <= 0)
+    {
+        return IDLE_INTERVAL_MS;
+    }
+
+    int numChannels = (int) std::min<uint32_t>(reader->numChannels, 2);
+    int numRead = (int) reader->read(readChannels.data(), (uint64_t) numFrames);
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        std::fill(readBuffer[channel].begin() + numRead, readBuffer[channel].begin() + numFrames, 0.0);
+    }
+    writeToRing(end, numFrames, numChannels);
+
+    // the frames must be in the ring before the voice can see them
+    written = end + numFrames;
+    return 0;
+}
+
+void SampleStreamer::openNextRequest()
+{
+    int start1, size1, start2, size2;
+    requestFifo.prepareToRead(1, start1, size1, start2, size2);
+    Request request = requests[start1];
+    requestFifo.finishedRead(1);
+
+    close();
+    current = request.sample;
+    if (current != nullptr)
+    {
+        // the head of the sample is in memory, so streaming starts just after it
+        reader = std::make_unique<WaveReader>(current->path);
+        reader->seek((uint64_t) current->headLength);
+        readBuffer.resize(reader->numChannels);
+        readChannels.resize(reader->numChannels);
+        for (uint32_t channel = 0; channel < reader->numChannels; channel++)
+        {
+            readBuffer[channel].resize(READ_BLOCK_SIZE);
+            readChannels[channel] = readBuffer[channel].data();
+        }
+        consumed = current->headLength;
+        written = current->headLength;
+    }
+
+    // the positions must be set before the voice can see them
+    readyGeneration = request.generation;
+}
+
+void SampleStreamer::close()
+{
+    reader.reset();
+    if (current != nullptr)
+    {
+        current->numUsers--;
+        current = nullptr;
+    }
+}
+
+void SampleStreamer::writeToRing(juce::int64 frame, int numFrames, int numChannels)
+{
+    // a mono file is written to both channels, so the voice can read it like a stereo one
+    for (int channel = 0; channel < 2; channel++)
+    {
+        const double* in = readBuffer[std::min(channel, numChannels - 1)].data();
+        float* out = ring.getWritePointer(channel);
+        for (int i = 0; i < numFrames; i++)
+        {
+            int position = (int) ((frame + i) % ringLength);
+            out[position] = (float) in[i];
+            out[position + ringLength] = (float) in[i];
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "SoundSlot.h"
+#include "WaveReader.hpp"
+
+//==============================================================================
+/**
+    Reads the part of a streamed ShiftedSample that is not in memory, ahead of the
+    voice that plays it.
+
+    Each voice has its own streamer. The voice asks for a sample to be streamed from
+    the audio thread through a lock-free queue, and a juce::TimeSliceThread shared by
+    all streamers opens the file and keeps a ring buffer filled ahead of the voice.
+
+    Every frame is written to the ring twice, once in each half, so any window of up to
+    the ring's length can be read as one contiguous block. The voice never waits for the
+    reader: if the frames it needs are not there yet, it gets nothing and plays silence.
+*/
+class SampleStreamer : public juce::TimeSliceClient
+{
+public:
+  // frames read from the file in one time slice
+  static const int READ_BLOCK_SIZE = 4096;
+  static const int MAX_PENDING_REQUESTS = 8;
+
+  // how long the thread can sleep when there is nothing to read
+  static const int IDLE_INTERVAL_MS = 5;
+
+  ~SampleStreamer() override;
+
+  // not real-time safe, neither the thread nor the voice can be using the streamer
+  // samples that were being streamed are let go, and voices playing them get silence
+  void prepare(int ringLength);
+  void reset();
+
+  // the longest window that read can return
+  int getMaxReadLength() const;
+
+  // real-time safe, called from the voice on the audio thread
+  // the streamer counts itself as a user of the sample until it moves on to another one
+  void start(ShiftedSample* sample);
+  void stop();
+
+  // points channels at frames [first, first + count) of the file, both channels are set even if it is mono
+  // returns false if they have not been read yet, frames past the end of the file are zero
+  // first must never go backwards while the same sample is streamed
+  bool read(juce::int64 first, int count, const float* channels[2]);
+
+  int useTimeSlice() override;
+
+private:
+  struct Request
+  {
+    ShiftedSample* sample;
+    uint64_t generation;
+  };
+
+  juce::AbstractFifo requestFifo{ MAX_PENDING_REQUESTS };
+  Request requests[MAX_PENDING_REQUESTS] = {};
+
+  // the audio thread moves generation for every request, and the reader publishes
+  // the generation it is streaming once the frames of that request can be read
+  uint64_t generation = 0;
+  std::atomic<uint64_t> readyGeneration{ 0 };
+  std::atomic<juce::int64> consumed{ 0 };
+  std::atomic<juce::int64> written{ 0 };
+
+  int ringLength = 0;
+  juce::AudioBuffer<float> ring;
+
+  // only touched by the reader
+  ShiftedSample* current = nullptr;
+  std::unique_ptr<WaveReader> reader;
+  std::vector<std::vector<double>> readBuffer;
+  std::vector<double*> readChannels;
+
+  void openNextRequest();
+  void close();
+  void writeToRing(juce::int64 frame, int numFrames, int numChannels);
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleStreamer)
+};
\ No newline at end of file
@@ -0,0 +1,335 @@
+#include "SlotVoice.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+bool SlotSound::appliesToNote(int midiNoteNumber)
+{
+    return true;
+}
+
+bool SlotSound::appliesToChannel(int midiChannel)
+{
+    return true;
+}
+
+SlotVoice::SlotVoice(SoundSlot& slot, VariantCache& variants, SampleStreamer& streamer,
+    juce::AudioBuffer<float>& scratch, int index, const std::atomic<int>& numActiveVoices)
+    : slot(slot), variants(variants), streamer(streamer), scratch(scratch), index(index), numActiveVoices(numActiveVoices)
+{
+}
+
+SlotVoice::~SlotVoice()
+{
+    if (playingSample != nullptr)
+    {
+        playingSlot->release(playingSample);
+    }
+}
+
+bool SlotVoice::canPlaySound(juce::SynthesiserSound* sound)
+{
+    return index < numActiveVoices && dynamic_cast<SlotSound*>(sound) != nullptr;
+}
+
+void SlotVoice::startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int currentPitchWheelPosition)
+{
+    // a voice can be stolen while it is still holding a sample
+    if (playingSample != nullptr)
+    {
+        if (playingSample->isStreamed())
+        {
+            streamer.stop();
+        }
+        playingSlot->release(playingSample);
+    }
+
+    playingSlot = &slot;
+    playingSample = slot.acquire();
+    double semitones = midiNoteNumber - ROOT_NOTE;
+
+    // the variant closest to the note is used if it is closer than the sample for the whole keyboard
+    if (variants.isEnabled())
+    {
+        int targetPitch = midiNoteNumber - ROOT_NOTE + variants.getBasePitch();
+        ShiftedSample* variant = variants.acquireClosest(targetPitch);
+        if (variant != nullptr && (playingSample == nullptr
+            || std::abs(targetPitch - variant->pitch) < std::abs(targetPitch - playingSample->pitch)))
+        {
+            if (playingSample != nullptr)
+            {
+                slot.release(playingSample);
+            }
+            playingSlot = &variants.getSlots();
+            playingSample = variant;
+        }
+        else if (variant != nullptr)
+        {
+            variants.getSlots().release(variant);
+        }
+
+        if (playingSample != nullptr)
+        {
+            semitones = targetPitch - playingSample->pitch;
+        }
+    }
+
+    if (playingSample == nullptr)
+    {
+        clearCurrentNote();
+        return;
+    }
+
+    // the head plays from memory while the streamer opens the file
+    if (playingSample->isStreamed())
+    {
+        streamer.start(playingSample);
+    }
+
+    pitchRatio = std::pow(2.0, semitones / 12.0) * playingSample->sampleRate / getSampleRate();
+    sourceSamplePosition = 0.0;
+    gain = velocity;
+
+    level = 0.0f;
+    levelDelta = (float) (1.0 / (ATTACK_SECONDS * getSampleRate()));
+    releasing = false;
+}
+
+void SlotVoice::stopNote(float velocity, bool allowTailOff)
+{
+    if (allowTailOff)
+    {
+        // the release starts from wherever the attack got to
+        releasing = true;
+        levelDelta = (float) (-level / (RELEASE_SECONDS * getSampleRate()));
+        if (level <= 0.0f)
+        {
+            endNote();
+        }
+    }
+    else
+    {
+        endNote();
+    }
+}
+
+void SlotVoice::pitchWheelMoved(int newValue)
+{
+}
+
+void SlotVoice::controllerMoved(int controllerNumber, int newValue)
+{
+}
+
+void SlotVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    const int numOutputChannels = outputBuffer.getNumChannels();
+    while (playingSample != nullptr && numSamples > 0)
+    {
+        // stop at the end of the scratch buffer, the sample and the release, whichever is first
+        int numSourceSamples = (int) std::ceil((playingSample->length - sourceSamplePosition) / pitchRatio);
+        int n = juce::jmin(numSamples, scratch.getNumSamples(), numSourceSamples, getEnvelopeSamplesLeft());
+        if (n <= 0)
+        {
+            endNote();
+            break;
+        }
+
+        // the block may be cut short where the head ends or the streamer's window does
+        const float* source[2];
+        double position;
+        bool available = getSource(n, source, position);
+
+        // the envelope is linear, so one ramp covers the whole block
+        float startGain = level * gain;
+        level = juce::jlimit(0.0f, 1.0f, level + levelDelta * n);
+        float endGain = level * gain;
+        if (!releasing && level >= 1.0f)
+        {
+            levelDelta = 0.0f;
+        }
+
+        // on an underrun nothing is mixed, but the note still moves on
+        int numSourceChannels = playingSample->data.getNumChannels();
+        if (available)
+        {
+            int sourceStart = (int) position;
+            bool direct = pitchRatio == 1.0 && sourceStart == position;
+            const float* mix[2] = { source[0] + sourceStart, source[1] + sourceStart };
+            if (!direct)
+            {
+                renderInterpolated(source, position, n);
+                mix[0] = scratch.getReadPointer(0);
+                mix[1] = scratch.getReadPointer(numSourceChannels > 1 ? 1 : 0);
+            }
+
+            if (numOutputChannels > 1)
+            {
+                for (int channel = 0; channel < juce::jmin(numOutputChannels, 2); channel++)
+                {
+                    addWithRamp(outputBuffer.getWritePointer(channel, startSample), mix[channel], n, startGain, endGain);
+                }
+            }
+            else
+            {
+                // a stereo sample is mixed down to a mono output
+                float mixGain = numSourceChannels > 1 ? 0.5f : 1.0f;
+                for (int channel = 0; channel < juce::jmin(numSourceChannels, 2); channel++)
+                {
+                    addWithRamp(outputBuffer.getWritePointer(0, startSample), mix[channel], n, startGain * mixGain, endGain * mixGain);
+                }
+            }
+        }
+
+        sourceSamplePosition += pitchRatio * n;
+        startSample += n;
+        numSamples -= n;
+
+        if (releasing && level <= 0.0f)
+        {
+            endNote();
+        }
+    }
+}
+
+int SlotVoice::getEnvelopeSamplesLeft() const
+{
+    if (!releasing)
+    {
+        return std::numeric_limits<int>::max();
+    }
+    return levelDelta < 0.0f ? (int) std::ceil(level / -levelDelta) : 0;
+}
+
+bool SlotVoice::getSource(int& numSamples, const float* source[2], double& position)
+{
+    // source[channel][position] is the sample at sourceSamplePosition
+    // a mono sample has both channels pointing at the same samples
+    const juce::AudioBuffer<float>& data = playingSample->data;
+    if (playingSample->isCompressed())
+    {
+        // the window is decoded into the last 2 channels of the scratch buffer,
+        // the first 2 are left for the interpolated output
+        // decoding past the end gives zeros, like the extra sample after data
+        numSamples = juce::jmin(numSamples, (int) ((scratch.getNumSamples() - 3) / pitchRatio) + 1);
+        int first = (int) sourceSamplePosition;
+        int last = (int) (sourceSamplePosition + (numSamples - 1) * pitchRatio) + 1;
+        const CompressedSamples& compressed = *playingSample->compressed;
+        for (int channel = 0; channel < juce::jmin(compressed.getNumChannels(), 2); channel++)
+        {
+            compressed.decode(channel, first, last - first + 1, scratch.getWritePointer(2 + channel));
+        }
+        source[0] = scratch.getReadPointer(2);
+        source[1] = scratch.getReadPointer(compressed.getNumChannels() > 1 ? 3 : 2);
+        position = sourceSamplePosition - first;
+        return true;
+    }
+
+    if (sourceSamplePosition < playingSample->headLength)
+    {
+        // the head has one more sample after it, so every position before its end can be interpolated
+        // while the sample is rendering, only positions with both neighbours rendered can be
+        int renderedLength = playingSample->renderedLength.load();
+        double playableEnd = renderedLength < playingSample->length ? renderedLength - 1 : playingSample->headLength;
+        if (sourceSamplePosition >= playableEnd)
+        {
+            // the note has caught up with the render
+            return false;
+        }
+        numSamples = juce::jmin(numSamples, (int) std::ceil((playableEnd - sourceSamplePosition) / pitchRatio));
+        source[0] = data.getReadPointer(0);
+        source[1] = data.getReadPointer(juce::jmin(1, data.getNumChannels() - 1));
+        position = sourceSamplePosition;
+        return true;
+    }
+
+    // a window covers the samples on both sides of every position in the block
+    numSamples = juce::jmin(numSamples, (int) ((streamer.getMaxReadLength() - 3) / pitchRatio) + 1);
+    juce::int64 first = (juce::int64) sourceSamplePosition;
+    juce::int64 last = (juce::int64) (sourceSamplePosition + (numSamples - 1) * pitchRatio) + 1;
+    position = sourceSamplePosition - first;
+    return streamer.read(first, (int) (last - first + 1), source);
+}
+
+void SlotVoice::renderInterpolated(const float* const* source, double position, int numSamples)
+{
+    // linear interpolation into the scratch buffer, the source has one extra sample at the end for position + 1
+    // the block is done a chunk at a time on the stack: the neighbours of each position are gathered,
+    // then both channels are interpolated with vector operations
+    int numSourceChannels = playingSample->data.getNumChannels();
+    alignas(16) int left[CHUNK_SIZE];
+    alignas(16) float alpha[CHUNK_SIZE];
+    alignas(16) float leftSamples[CHUNK_SIZE];
+    alignas(16) float rightSamples[CHUNK_SIZE];
+    for (int start = 0; start < numSamples; start += CHUNK_SIZE)
+    {
+        int count = juce::jmin(CHUNK_SIZE, numSamples - start);
+
+        // every position is computed from the start of the block instead of by adding up pitchRatio,
+        // so the positions don't depend on each other
+        for (int i = 0; i < count; i++)
+        {
+            double inPosition = position + (start + i) * pitchRatio;
+            left[i] = (int) inPosition;
+            alpha[i] = (float) (inPosition - left[i]);
+        }
+
+        for (int channel = 0; channel < juce::jmin(numSourceChannels, 2); channel++)
+        {
+            const float* in = source[channel];
+            for (int i = 0; i < count; i++)
+            {
+                leftSamples[i] = in[left[i]];
+                rightSamples[i] = in[left[i] + 1];
+            }
+
+            // out = left + (right - left) * alpha
+            juce::FloatVectorOperations::subtract(rightSamples, leftSamples, count);
+            juce::FloatVectorOperations::multiply(rightSamples, alpha, count);
+            juce::FloatVectorOperations::add(scratch.getWritePointer(channel, start), leftSamples, rightSamples, count);
+        }
+    }
+}
+
+void SlotVoice::addWithRamp(float* destination, const float* source, int numSamples, float startGain, float endGain)
+{
+    // AudioBuffer::addFromWithRamp adds one sample at a time whenever the gain changes,
+    // so the ramp is written out a chunk at a time and multiplied in with vector operations
+    if (startGain == endGain)
+    {
+        juce::FloatVectorOperations::addWithMultiply(destination, source, startGain, numSamples);
+        return;
+    }
+
+    // the same ramp as addFromWithRamp, which steps the gain after every sample
+    float increment = (endGain - startGain) / (float) numSamples;
+    alignas(16) float gains[CHUNK_SIZE];
+    for (int start = 0; start < numSamples; start += CHUNK_SIZE)
+    {
+        int count = juce::jmin(CHUNK_SIZE, numSamples - start);
+        for (int i = 0; i < count; i++)
+        {
+            gains[i] = startGain + increment * (float) (start + i);
+        }
+        juce::FloatVectorOperations::addWithMultiply(destination + start, source + start, gains, count);
+    }
+}
+
+void SlotVoice::endNote()
+{
+    // only the user count changes here, the sample is freed by SoundSlot on a background thread
+    if (playingSample != nullptr)
+    {
+        if (playingSample->isStreamed())
+        {
+            streamer.stop();
+        }
+        playingSlot->release(playingSample);
+        playingSample = nullptr;
+    }
+    level = 0.0f;
+    levelDelta = 0.0f;
+    releasing = false;
+    clearCurrentNote();
+}
\ No newline at end of file
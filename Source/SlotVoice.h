@@ -0,0 +1,101 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "SampleStreamer.h"
+#include "SoundSlot.h"
+#include "VariantCache.h"
+
+//==============================================================================
+/**
+    The only sound given to the synthesiser. It applies to every note, and the
+    samples it plays come from the SoundSlot at the time each note starts.
+*/
+class SlotSound : public juce::SynthesiserSound
+{
+public:
+  bool appliesToNote(int midiNoteNumber) override;
+  bool appliesToChannel(int midiChannel) override;
+};
+
+//==============================================================================
+/**
+    Plays the sample from a SoundSlot, transposed from the root note by resampling,
+    like juce::SamplerVoice.
+
+    If the VariantCache is enabled, the note plays the closest variant instead, so only
+    the remaining distance is made up by resampling.
+
+    The sample is acquired when the note starts and released when it ends, so a sample
+    that is replaced while it is playing stays alive until the note is over.
+
+    A block is rendered into a scratch buffer shared by all voices, then mixed into the
+    output with a gain ramp, so the envelope is evaluated once per block instead of once
+    per sample. Both are done a chunk of samples at a time: the neighbours of every
+    position in the chunk are gathered, then interpolated and mixed with the ramp using
+    FloatVectorOperations. A note that plays its variant at its own pitch and rate is mixed straight
+    from the sample without interpolating. Only voices below the active voice count take
+    new notes, so the count can change without adding or removing voices.
+
+    A compressed sample is decoded a block at a time, just before it is played.
+
+    A streamed sample is played from its head in memory first, then from the voice's
+    SampleStreamer. If the streamer falls behind, or the note reaches the end of a sample
+    that is still rendering, the voice plays silence for that block and keeps its place
+    instead of waiting.
+*/
+class SlotVoice : public juce::SynthesiserVoice
+{
+public:
+  static const int ROOT_NOTE = 72;
+
+  // same envelope as the juce::SamplerSound that was used before, both stages are linear
+  static constexpr double ATTACK_SECONDS = 0.1;
+  static constexpr double RELEASE_SECONDS = 0.1;
+
+  static const int NUM_SCRATCH_CHANNELS = 4;
+  static const int MIN_SCRATCH_SIZE = 64;
+
+  // scratch must have NUM_SCRATCH_CHANNELS channels and at least MIN_SCRATCH_SIZE samples,
+  // it is sized by the processor before playback
+  SlotVoice(SoundSlot& slot, VariantCache& variants, SampleStreamer& streamer,
+    juce::AudioBuffer<float>& scratch, int index, const std::atomic<int>& numActiveVoices);
+  ~SlotVoice() override;
+
+  bool canPlaySound(juce::SynthesiserSound* sound) override;
+  void startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int currentPitchWheelPosition) override;
+  void stopNote(float velocity, bool allowTailOff) override;
+  void pitchWheelMoved(int newValue) override;
+  void controllerMoved(int controllerNumber, int newValue) override;
+  void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
+
+private:
+  SoundSlot& slot;
+  VariantCache& variants;
+  SampleStreamer& streamer;
+  SoundSlot* playingSlot = nullptr;
+  ShiftedSample* playingSample = nullptr;
+  juce::AudioBuffer<float>& scratch;
+  int index;
+  const std::atomic<int>& numActiveVoices;
+
+  double pitchRatio = 0.0;
+  double sourceSamplePosition = 0.0;
+  float gain = 0.0f;
+
+  // envelope level in [0, 1], which moves by levelDelta per sample until it reaches 1 or 0
+  float level = 0.0f;
+  float levelDelta = 0.0f;
+  bool releasing = false;
+
+  // interpolation and gain ramps are done in chunks of this many samples, in arrays on the stack
+  static const int CHUNK_SIZE = 64;
+
+  int getEnvelopeSamplesLeft() const;
+  bool getSource(int& numSamples, const float* source[2], double& position);
+  void renderInterpolated(const float* const* source, double position, int numSamples);
+  static void addWithRamp(float* destination, const float* source, int numSamples, float startGain, float endGain);
+  void endNote();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SlotVoice)
+};
\ No newline at end of file
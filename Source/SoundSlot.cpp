@@ -0,0 +1,180 @@
+#include "SoundSlot.h"
+
+#include "SampleBufferReader.h"
+#include "WaveReader.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+ShiftedSample::ShiftedSample(const SampleBuffer& samples, double sampleRate, int pitch)
+    : length((int) std::min<uint64_t>(samples.getNumSamples(), (uint64_t) (sampleRate * MAX_LENGTH_SECONDS))),
+    headLength(length), sampleRate(sampleRate), pitch(pitch), deleteFile(false)
+{
+    SampleBufferReader reader(samples, sampleRate);
+    data.setSize((int) samples.getNumChannels(), length + 1);
+    data.clear();
+    reader.read(&data, 0, length, 0, true, true);
+    renderedLength = length;
+}
+
+ShiftedSample::ShiftedSample(uint32_t numChannels, uint64_t numSamples, double sampleRate, int pitch)
+    : length((int) std::min<uint64_t>(numSamples, (uint64_t) (sampleRate * MAX_LENGTH_SECONDS))),
+    headLength(length), sampleRate(sampleRate), pitch(pitch), deleteFile(false)
+{
+    data.setSize((int) numChannels, length + 1);
+    data.clear();
+}
+
+ShiftedSample::ShiftedSample(const std::string& path, int headLength, int pitch, bool deleteFile)
+    : pitch(pitch), path(path), deleteFile(deleteFile)
+{
+    WaveReader reader(path);
+    length = (int) std::min<uint64_t>(reader.numSamples, std::numeric_limits<int>::max() - 1);
+    this->headLength = std::min(headLength, length);
+    sampleRate = reader.sampleRate;
+
+    // the extra sample is the first one after the head, so interpolating across the end of the head is seamless
+    int numRead = std::min(this->headLength + 1, length);
+    SampleBuffer head(reader.numChannels, (std::size_t) numRead);
+    std::vector<double*> channels(reader.numChannels);
+    for (uint32_t channel = 0; channel < reader.numChannels; channel++)
+    {
+        channels[channel] = head.getChannel(channel);
+    }
+    reader.read(channels.data(), (uint64_t) numRead);
+
+    SampleBufferReader headReader(head, sampleRate);
+    data.setSize((int) reader.numChannels, this->headLength + 1);
+    data.clear();
+    headReader.read(&data, 0, numRead, 0, true, true);
+    renderedLength = length;
+}
+
+ShiftedSample::~ShiftedSample()
+{
+    if (deleteFile)
+    {
+        std::remove(path.c_str());
+    }
+}
+
+std::size_t ShiftedSample::getSizeInBytes() const
+{
+    if (compressed != nullptr)
+    {
+        return compressed->getSizeInBytes();
+    }
+    return (std::size_t) data.getNumChannels() * (headLength + 1) * sizeof(float);
+}
+
+bool ShiftedSample::isStreamed() const
+{
+    return headLength < length;
+}
+
+void ShiftedSample::compress()
+{
+    jassert(!isStreamed() && renderedLength == length);
+    compressed = std::make_unique<CompressedSamples>(data, length);
+    data.setSize(data.getNumChannels(), 0);
+}
+
+bool ShiftedSample::isCompressed() const
+{
+    return compressed != nullptr;
+}
+
+void ShiftedSample::render(const SampleBuffer& samples, uint64_t numRendered)
+{
+    int start = renderedLength.load();
+    int end = (int) std::min<uint64_t>(numRendered, length);
+    if (end <= start)
+    {
+        return;
+    }
+
+    SampleBufferReader reader(samples, sampleRate);
+    reader.read(&data, start, end - start, start, true, true);
+
+    // the samples must be in place before a voice can see them
+    renderedLength = end;
+}
+
+SoundSlot::SoundSlot(int numKeys)
+    : numKeys(numKeys), active(new std::atomic<ShiftedSample*>[numKeys])
+{
+    for (int key = 0; key < numKeys; key++)
+    {
+        active[key] = nullptr;
+    }
+}
+
+SoundSlot::~SoundSlot()
+{
+    // the audio thread has stopped by now, so everything can be freed
+    for (int key = 0; key < numKeys; key++)
+    {
+        delete active[key].load();
+    }
+}
+
+int SoundSlot::getNumKeys() const
+{
+    return numKeys;
+}
+
+void SoundSlot::publish(std::unique_ptr<ShiftedSample> sample, int key)
+{
+    jassert(key >= 0 && key < numKeys);
+
+    // the swap must happen before the epoch is read,
+    // so any block that starts afterwards only sees the new sample
+    ShiftedSample* old = active[key].exchange(sample.release());
+    if (old != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        retired.push_back({ std::unique_ptr<ShiftedSample>(old), epoch.load() });
+    }
+    collectGarbage();
+}
+
+void SoundSlot::collectGarbage()
+{
+    std::lock_guard<std::mutex> lock(retiredMutex);
+    uint64_t currentEpoch = epoch.load();
+    auto isUnused = [currentEpoch](const RetiredSample& retiredSample)
+        {
+            // if the sample was retired during a block, that block may still acquire it
+            // once the block is over, the user count is final
+            bool blockFinished = retiredSample.epoch % 2 == 0 || currentEpoch > retiredSample.epoch;
+            return blockFinished && retiredSample.sample->numUsers.load() == 0;
+        };
+    retired.erase(std::remove_if(retired.begin(), retired.end(), isUnused), retired.end());
+}
+
+void SoundSlot::beginBlock()
+{
+    epoch++;
+}
+
+void SoundSlot::endBlock()
+{
+    epoch++;
+}
+
+ShiftedSample* SoundSlot::acquire(int key)
+{
+    ShiftedSample* sample = active[key].load();
+    if (sample != nullptr)
+    {
+        sample->numUsers++;
+    }
+    return sample;
+}
+
+void SoundSlot::release(ShiftedSample* sample)
+{
+    // the sample is freed on a background thread, never here
+    sample->numUsers--;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CompressedSamples.h"
+#include "SampleBuffer.hpp"
+
+//==============================================================================
+/**
+    A shifted clip converted to float, ready to be played by SlotVoice.
+
+    Either the whole clip is in memory, or only its head is and the rest is streamed
+    from a WAV file by a SampleStreamer while it plays.
+
+    A sample in memory can be compressed to 16 bits once it is rendered, in which case
+    the voice decodes the part it plays from compressed instead of reading data.
+
+    A sample in memory can also be played while it is still being rendered. The render
+    fills it from the start, and samples before renderedLength are never modified again,
+    so the audio thread can read them without locking.
+*/
+class ShiftedSample
+{
+public:
+  // longer clips are cut when they are kept in memory, as juce::SamplerSound did
+  static constexpr double MAX_LENGTH_SECONDS = 10.0;
+
+  // keeps the whole clip in memory
+  ShiftedSample(const SampleBuffer& samples, double sampleRate, int pitch);
+
+  // keeps the whole clip in memory, but it is filled in later by render
+  ShiftedSample(uint32_t numChannels, uint64_t numSamples, double sampleRate, int pitch);
+
+  // keeps the first headLength samples of the file in memory and streams the rest
+  // if deleteFile is true, the file is deleted along with the sample
+  ShiftedSample(const std::string& path, int headLength, int pitch, bool deleteFile);
+  ~ShiftedSample();
+
+  std::size_t getSizeInBytes() const;
+  bool isStreamed() const;
+
+  // not real-time safe, only called by the thread that renders the sample
+  // converts the samples from renderedLength up to numRendered and makes them playable
+  void render(const SampleBuffer& samples, uint64_t numRendered);
+
+  // not real-time safe, must be called on a fully rendered sample in memory before it is published
+  // frees data, keeping only its number of channels
+  void compress();
+  bool isCompressed() const;
+
+  // the head plus one more sample (or zero if that is past the end),
+  // so interpolation can read one past the last sample of the head
+  juce::AudioBuffer<float> data;
+  int length;
+  int headLength;
+  double sampleRate;
+  int pitch;
+
+  // the number of samples from the start that are final, equal to length once rendering is done
+  std::atomic<int> renderedLength{ 0 };
+
+  std::unique_ptr<CompressedSamples> compressed;
+
+  // where the rest of the samples are read from if the sample is streamed
+  std::string path;
+  bool deleteFile;
+
+  // number of voices playing this sample, only touched through SoundSlot
+  std::atomic<int> numUsers{ 0 };
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ShiftedSample)
+};
+
+//==============================================================================
+/**
+    Holds the samples that new notes start with, one per key.
+
+    A background thread publishes a new sample by swapping an atomic pointer, and the
+    audio thread picks it up at the next note on without locking or allocating.
+    The old sample is retired and freed later on a background thread, once the audio
+    thread has finished the block it may have read it in and no voice is still playing it.
+
+    The audio thread brackets every block with beginBlock/endBlock, which moves an epoch
+    counter that is odd while a block is being rendered. The epoch is shared by all keys.
+*/
+class SoundSlot
+{
+public:
+  SoundSlot(int numKeys = 1);
+  ~SoundSlot();
+
+  // not real-time safe, called from background threads
+  // publishing nullptr empties the key
+  void publish(std::unique_ptr<ShiftedSample> sample, int key = 0);
+  void collectGarbage();
+
+  // real-time safe, called from the audio thread
+  void beginBlock();
+  void endBlock();
+
+  // returns the key's sample and counts the caller as one of its users, or nullptr if empty
+  // must be called between beginBlock and endBlock
+  ShiftedSample* acquire(int key = 0);
+  void release(ShiftedSample* sample);
+
+  int getNumKeys() const;
+
+private:
+  int numKeys;
+  std::unique_ptr<std::atomic<ShiftedSample*>[]> active;
+  std::atomic<uint64_t> epoch{ 0 };
+
+  struct RetiredSample
+  {
+    std::unique_ptr<ShiftedSample> sample;
+    uint64_t epoch;
+  };
+
+  // only touched by background threads
+  std::vector<RetiredSample> retired;
+  std::mutex retiredMutex;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoundSlot)
+};
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef SPSCQUEUE_HEADER
+#define SPSCQUEUE_HEADER
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// a bounded queue between one producer thread and one consumer thread, which never locks
+// each side only writes its own index, and publishes it once the slot it covers is ready
+template <typename T>
+class SpscQueue
+{
+public:
+    // capacity is rounded up to a power of 2
+    SpscQueue(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while (size < capacity)
+        {
+            size *= 2;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    // returns false if the queue is full
+    bool push(const T& value)
+    {
+        std::size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - head.load(std::memory_order_acquire) == slots.size())
+        {
+            return false;
+        }
+        slots[tail & mask] = value;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // returns false if the queue is empty
+    bool pop(T& value)
+    {
+        std::size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = slots[head & mask];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // the waiting versions are for threads that have nothing else to do,
+    // they yield for a while before sleeping, so a stage that waits on a slower one uses little CPU
+    void pushWaiting(const T& value)
+    {
+        for (int attempt = 0; !push(value); attempt++)
+        {
+            wait(attempt);
+        }
+    }
+
+    T popWaiting()
+    {
+        T value;
+        for (int attempt = 0; !pop(value); attempt++)
+        {
+            wait(attempt);
+        }
+        return value;
+    }
+
+private:
+    static const int YIELDS_BEFORE_SLEEPING = 64;
+
+    std::vector<T> slots;
+    std::size_t mask;
+
+    // kept on separate cache lines, so the 2 threads do not invalidate each other's index
+    alignas(64) std::atomic<std::size_t> head{ 0 };
+    alignas(64) std::atomic<std::size_t> tail{ 0 };
+
+    void wait(int attempt)
+    {
+        if (attempt < YIELDS_BEFORE_SLEEPING)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// the pool and queue of the worker running on this thread, if any
+static thread_local ThreadPool* currentPool = nullptr;
+static thread_local std::size_t currentQueue = 0;
+
+ThreadPool::ThreadPool(unsigned numThreads) : numQueued(0), stopping(false)
+{
+    if (numThreads == 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // every queue exists before the first worker can look for jobs
+    for (unsigned i = 0; i < numThreads; i++)
+    {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    // the thread calling parallelFor also runs tasks, so it counts as one of the threads
+    for (unsigned i = 1; i < numThreads; i++)
+    {
+        workers.emplace_back(&ThreadPool::run, this, (std::size_t) i - 1);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::getNumThreads()
+{
+    return (unsigned) workers.size() + 1;
+}
+
+ThreadPool& ThreadPool::getShared()
+{
+    static ThreadPool shared;
+    return shared;
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& task)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (count == 1 || workers.empty())
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            task(i);
+        }
+        return;
+    }
+
+    // indices are claimed from a shared counter, so the calling thread keeps working
+    // even if every worker is busy (e.g. when parallelFor is called from a task)
+    // the state is shared since workers may only pick up their job after everything is done
+    struct State
+    {
+        std::atomic<std::size_t> next{ 0 };
+        std::atomic<std::size_t> done{ 0 };
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+
+    auto work = [state, count, &task]
+        {
+            std::size_t i;
+            while ((i = state->next.fetch_add(1)) < count)
+            {
+                task(i);
+                if (state->done.fetch_add(1) + 1 == count)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->condition.notify_all();
+                }
+            }
+        };
+
+    std::size_t numJobs = std::min<std::size_t>(workers.size(), count - 1);
+    for (std::size_t i = 0; i < numJobs; i++)
+    {
+        push(work);
+    }
+
+    work();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&] { return state->done.load() == count; });
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    if (workers.empty())
+    {
+        task();
+        return;
+    }
+    push(std::move(task));
+}
+
+void ThreadPool::push(std::function<void()> job)
+{
+    Queue& queue = *queues[currentPool == this ? currentQueue : workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    numQueued++;
+
+    // a worker that has just found every queue empty is either still holding the mutex,
+    // and will see numQueued when it checks again, or already waiting for this notification
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    condition.notify_one();
+}
+
+bool ThreadPool::pop(std::size_t index, std::function<void()>& job)
+{
+    for (std::size_t i = 0; i < queues.size(); i++)
+    {
+        Queue& queue = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            // newest from its own queue, oldest from the others
+            if (i == 0)
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            }
+            else
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+            numQueued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(std::size_t index)
+{
+    currentPool = this;
+    currentQueue = index;
+    while (true)
+    {
+        std::function<void()> job;
+        if (pop(index, job))
+        {
+            job();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return stopping || numQueued.load() > 0; });
+        if (stopping && numQueued.load() == 0)
+        {
+            return;
+        }
+    }
+}
\ No newline at end of file
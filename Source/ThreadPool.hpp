@@ -0,0 +1,60 @@
+#ifndef THREADPOOL_HEADER
+#define THREADPOOL_HEADER
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    // 0 uses one thread per hardware thread
+    ThreadPool(unsigned numThreads = 0);
+    ~ThreadPool();
+
+    // runs task(0) ... task(count - 1) on the workers and the calling thread,
+    // returning once every index has been run
+    // tasks must be independent, since they run in no particular order
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+    // runs task on one of the workers and returns without waiting for it
+    // tasks submitted from a task run next on the same worker, unless an idle worker steals them first
+    void submit(std::function<void()> task);
+
+    // number of threads that run tasks, including the calling thread
+    unsigned getNumThreads();
+
+    // pool shared by everything that does not need its own
+    static ThreadPool& getShared();
+
+private:
+    // each worker has its own queue, and the last queue takes the jobs of threads outside the pool
+    // a worker runs the newest job of its own queue first, then steals the oldest job of another,
+    // so the jobs a task makes stay on its thread while their data is still in cache
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::atomic<std::size_t> numQueued;
+
+    // only used to sleep while every queue is empty
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+
+    void run(std::size_t index);
+    void push(std::function<void()> job);
+    bool pop(std::size_t index, std::function<void()>& job);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "VariantCache.h"
+
+#include <cstdlib>
+
+VariantCache::VariantCache(RenderFunction render, int numWorkers)
+    : Thread("Variant Cache"), render(std::move(render)),
+    workers(numWorkers > 0 ? numWorkers : juce::jmax(1, (int) std::thread::hardware_concurrency() - 1))
+{
+    for (int key = 0; key < NUM_KEYS; key++)
+    {
+        requested[key] = false;
+        lastPlayed[key] = 0;
+        sizes[key] = 0;
+        rendering[key] = false;
+    }
+    startThread();
+}
+
+VariantCache::~VariantCache()
+{
+    // renders in progress stop at their next frame once the generation changes
+    generation++;
+    signalThreadShouldExit();
+    wakeUp.signal();
+    stopThread(10000);
+    workers.removeAllJobs(true, 10000);
+}
+
+void VariantCache::setEnabled(bool shouldBeEnabled)
+{
+    enabled = shouldBeEnabled;
+}
+
+bool VariantCache::isEnabled() const
+{
+    return enabled;
+}
+
+void VariantCache::setBasePitch(int pitch)
+{
+    basePitch = pitch;
+}
+
+int VariantCache::getBasePitch() const
+{
+    return basePitch;
+}
+
+void VariantCache::setMemoryBudget(std::size_t bytes)
+{
+    memoryBudget = bytes;
+    std::lock_guard<std::mutex> lock(stateMutex);
+    evict(-1);
+}
+
+void VariantCache::setCompressing(bool shouldCompress)
+{
+    compressing = shouldCompress;
+}
+
+bool VariantCache::isCompressing() const
+{
+    return compressing;
+}
+
+SoundSlot& VariantCache::getSlots()
+{
+    return slots;
+}
+
+void VariantCache::clear()
+{
+    generation++;
+    std::lock_guard<std::mutex> lock(stateMutex);
+    for (int key = 0; key < NUM_KEYS; key++)
+    {
+        slots.publish(nullptr, key);
+        sizes[key] = 0;
+    }
+    totalSize = 0;
+}
+
+ShiftedSample* VariantCache::acquireClosest(int offset)
+{
+    // only atomics are touched here, the cache's thread picks up the request when it next polls
+    int key = juce::jlimit(0, NUM_KEYS - 1, offset - MIN_OFFSET);
+    requested[key] = true;
+    lastPlayed[key] = ++playCounter;
+
+    // search outwards, preferring the variant above when 2 are equally close
+    for (int distance = 0; distance < NUM_KEYS; distance++)
+    {
+        for (int candidate : { key + distance, key - distance })
+        {
+            if (candidate >= 0 && candidate < NUM_KEYS)
+            {
+                if (ShiftedSample* sample = slots.acquire(candidate))
+                {
+                    return sample;
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+void VariantCache::run()
+{
+    while (!threadShouldExit())
+    {
+        wakeUp.wait(POLL_INTERVAL_MS);
+        if (!enabled)
+        {
+            continue;
+        }
+
+        for (int key = 0; key < NUM_KEYS; key++)
+        {
+            if (!requested[key].exchange(false))
+            {
+                continue;
+            }
+
+            // the played variant is queued before its neighbours
+            std::lock_guard<std::mutex> lock(stateMutex);
+            startRender(key);
+            for (int distance = 1; distance <= PREFETCH_DISTANCE; distance++)
+            {
+                startRender(key + distance);
+                startRender(key - distance);
+            }
+        }
+    }
+}
+
+void VariantCache::startRender(int key)
+{
+    // must be called with stateMutex held
+    if (key < 0 || key >= NUM_KEYS || sizes[key] != 0 || rendering[key])
+    {
+        return;
+    }
+
+    rendering[key] = true;
+    int renderGeneration = generation;
+    workers.addJob([this, key, renderGeneration]
+        {
+            auto shouldStop = [this, renderGeneration]
+                {
+                    return generation != renderGeneration || !enabled;
+                };
+            std::unique_ptr<ShiftedSample> sample = render(key + MIN_OFFSET, shouldStop);
+            if (sample != nullptr && compressing && !sample->isStreamed())
+            {
+                sample->compress();
+            }
+
+            std::lock_guard<std::mutex> lock(stateMutex);
+            rendering[key] = false;
+            if (sample == nullptr || shouldStop())
+            {
+                return;
+            }
+
+            sizes[key] = sample->getSizeInBytes();
+            totalSize += sizes[key];
+            slots.publish(std::move(sample), key);
+            evict(key);
+        });
+}
+
+void VariantCache::evict(int keyToKeep)
+{
+    // must be called with stateMutex held
+    // a variant that is still playing is kept alive by the slot until its notes end
+    while (totalSize > memoryBudget)
+    {
+        int oldestKey = -1;
+        for (int key = 0; key < NUM_KEYS; key++)
+        {
+            if (sizes[key] != 0 && key != keyToKeep && (oldestKey < 0 || lastPlayed[key] < lastPlayed[oldestKey]))
+            {
+                oldestKey = key;
+            }
+        }
+        if (oldestKey < 0)
+        {
+            break;
+        }
+
+        slots.publish(nullptr, oldestKey);
+        totalSize -= sizes[oldestKey];
+        sizes[oldestKey] = 0;
+    }
+}
\ No newline at end of file
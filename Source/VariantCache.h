@@ -0,0 +1,100 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "SoundSlot.h"
+
+//==============================================================================
+/**
+    Shifted variants of the clip, one per semitone offset, so every key can play a clip
+    shifted by the phase vocoder instead of one that is only resampled.
+
+    Variants are rendered on demand on worker threads when a note asks for one that is
+    missing, along with its neighbours, since nearby notes are likely to be played next.
+    Until then a note plays the closest variant that is ready. The least recently played
+    variants are dropped when the cache grows past its memory budget.
+
+    Variants in memory are compressed to 16 bits by default, so twice as many of them fit
+    in the same budget.
+*/
+class VariantCache : private juce::Thread
+{
+public:
+  // offsets in [MIN_OFFSET, MIN_OFFSET + NUM_KEYS) semitones from the clip can be cached
+  static const int NUM_KEYS = 128;
+  static const int MIN_OFFSET = -64;
+
+  // variants this many semitones either side of a played one are rendered ahead of time
+  static const int PREFETCH_DISTANCE = 2;
+
+  // how often the demand from the audio thread is checked
+  static const int POLL_INTERVAL_MS = 10;
+
+  static const std::size_t DEFAULT_MEMORY_BUDGET = 256 << 20;
+
+  // renders the clip shifted by offset semitones, or returns nullptr if shouldStop returned true
+  using RenderFunction = std::function<std::unique_ptr<ShiftedSample>(int offset, const std::function<bool()>& shouldStop)>;
+
+  // numWorkers is the number of variants rendered at once, 0 to use one less than the number of cores
+  VariantCache(RenderFunction render, int numWorkers = 0);
+  ~VariantCache() override;
+
+  void setEnabled(bool shouldBeEnabled);
+  bool isEnabled() const;
+
+  // the offset of the root note, so a note plays the variant offset by its distance from the root plus this
+  void setBasePitch(int pitch);
+  int getBasePitch() const;
+
+  void setMemoryBudget(std::size_t bytes);
+
+  // only applies to variants rendered afterwards
+  void setCompressing(bool shouldCompress);
+  bool isCompressing() const;
+
+  // drops every variant and cancels the renders in progress, e.g. after a new clip is loaded
+  void clear();
+
+  // real-time safe, called from the audio thread between beginBlock and endBlock of getSlots()
+  // returns the ready variant closest to offset, or nullptr if there is none
+  // the variant must be released through getSlots(), and a missing one is requested
+  ShiftedSample* acquireClosest(int offset);
+
+  SoundSlot& getSlots();
+
+private:
+  RenderFunction render;
+  SoundSlot slots{ NUM_KEYS };
+  juce::ThreadPool workers;
+  juce::WaitableEvent wakeUp;
+
+  std::atomic<bool> enabled{ false };
+  std::atomic<int> basePitch{ 0 };
+  std::atomic<std::size_t> memoryBudget{ DEFAULT_MEMORY_BUDGET };
+  std::atomic<bool> compressing{ true };
+
+  // renders of an older generation are cancelled and their results dropped
+  std::atomic<int> generation{ 0 };
+
+  // written by the audio thread
+  std::atomic<bool> requested[NUM_KEYS];
+  std::atomic<uint64_t> lastPlayed[NUM_KEYS];
+  std::atomic<uint64_t> playCounter{ 0 };
+
+  // only touched by the cache's thread and the workers
+  std::mutex stateMutex;
+  std::size_t sizes[NUM_KEYS];
+  bool rendering[NUM_KEYS];
+  std::size_t totalSize = 0;
+
+  void run() override;
+  void startRender(int key);
+  void evict(int keyToKeep);
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VariantCache)
+};
\ No newline at end of file
@@ -1,30 +1,38 @@
 #ifndef WAVE_HEADER
 #define WAVE_HEADER
 
+#include "SampleBuffer.hpp"
+
+#include <cstdint>
 #include <iostream>
+#include <string>
 #include <vector>
 
 class WaveFile
 {
 public:
-    // standard PCM header size for 8-bit and 16-bit
-    static const std::size_t PCM_HEADER_SIZE = 44;
-
-    uint32_t numSamples;
+    // 64-bit since RF64/BW64 files can hold more than 4 GB of samples
+    uint64_t numSamples;
     uint32_t numChannels;
     uint32_t sampleRate;
-    std::vector<std::vector<double>> samples;
+    SampleBuffer samples;
 
-    WaveFile(std::string filename);
+    // if headerOnly is true, only the metadata is read and samples is left empty
+    WaveFile(std::string filename, bool headerOnly = false);
+    // a file in the same format as other, but at sampleRate with room for numSamples samples
+    WaveFile(const WaveFile& other, uint32_t sampleRate, uint64_t numSamples);
     void write(std::string filename);
+    void write(std::string filename, uint32_t outputBitsPerSample, bool outputIeeeFloat = false);
+
+    uint32_t getBitsPerSample();
+    bool isIeeeFloat();
 
 private:
     // uint32_t since header data can contain up to 4 bytes = 32 bits
     uint32_t bitsPerSample;
+    bool ieeeFloat;
 
-    uint32_t littleEndianToInt(char* bytes, int size);
-    uint32_t bigEndianToInt(char* bytes, int size);
-    std::string intToLittleEndian(int value, int size);
+    std::vector<double*> getChannels();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,318 @@
+#include "WaveReader.hpp"
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+WaveReader::WaveReader(std::string filename)
+    // std::ios_base::binary is necessary for windows
+    : byteStream(filename, std::ios::binary), position(0), pool(nullptr)
+{
+    readHeader();
+}
+
+uint32_t WaveReader::getBitsPerSample()
+{
+    return bitsPerSample;
+}
+
+bool WaveReader::isIeeeFloat()
+{
+    return ieeeFloat;
+}
+
+void WaveReader::setThreadPool(ThreadPool* pool)
+{
+    this->pool = pool;
+}
+
+uint64_t WaveReader::getPosition()
+{
+    return position;
+}
+
+void WaveReader::seek(uint64_t frame)
+{
+    position = std::min(frame, numSamples);
+    uint64_t blockAlign = numChannels * (bitsPerSample / 8);
+    byteStream.clear();
+    byteStream.seekg(dataOffset + (std::streamoff) (position * blockAlign));
+}
+
+void WaveReader::readHeader()
+{
+    // WAVE file format: http://soundfile.sapp.org/doc/WaveFormat/
+    // RF64: https://tech.ebu.ch/docs/tech/tech3306v1_1.pdf
+    // BW64: https://www.itu.int/rec/R-REC-BS.2088
+    char headerBuffer[FORMAT_CHUNK_MAX_SIZE];
+    byteStream.read(headerBuffer, 12);
+    uint32_t riffId = bigEndianToInt(headerBuffer, 4);
+    assert(riffId == 0x52494646 || riffId == 0x52463634 || riffId == 0x42573634); // 0:  ChunkID (RIFF, RF64 or BW64)
+    assert(bigEndianToInt(&headerBuffer[8], 4) == 0x57415645); // 8:  Format (WAVE)
+
+    numSamples = 0;
+    numChannels = 0;
+    sampleRate = 0;
+    bitsPerSample = 0;
+    ieeeFloat = false;
+    dataOffset = 0;
+    dataSize = 0;
+
+    // 64-bit sizes from the ds64 chunk
+    // these replace the 32-bit sizes that are set to 0xffffffff
+    bool foundDs64 = false;
+    uint64_t ds64DataSize = 0;
+
+    // walk the chunks by their IDs and sizes until the data chunk is found,
+    // seeking past the ones that are not needed (LIST, bext, JUNK, cue, fact, ...)
+    // chunks are word aligned, so odd sized chunks are followed by a pad byte
+    bool foundFormat = false;
+    char chunkHeader[8];
+    while (byteStream.read(chunkHeader, 8))
+    {
+        uint32_t chunkId = bigEndianToInt(chunkHeader, 4);
+        uint32_t chunkSize = littleEndianToInt(&chunkHeader[4], 4);
+        uint64_t paddedSize = (uint64_t) chunkSize + (chunkSize & 1);
+
+        if (chunkId == 0x64733634) // ds64
+        {
+            // 0:  RiffSize, 8:  DataSize, 16: SampleCount, 24: TableLength
+            char ds64Buffer[24];
+            uint32_t readSize = std::min<uint32_t>(chunkSize, sizeof(ds64Buffer));
+            byteStream.read(ds64Buffer, readSize);
+            byteStream.seekg(paddedSize - readSize, std::ios::cur);
+            if (readSize >= 16)
+            {
+                ds64DataSize = littleEndianToLong(&ds64Buffer[8]);
+                foundDs64 = true;
+            }
+        }
+        else if (chunkId == 0x666d7420) // fmt
+        {
+            uint32_t readSize = std::min<uint32_t>(chunkSize, FORMAT_CHUNK_MAX_SIZE);
+            byteStream.read(headerBuffer, readSize);
+            byteStream.seekg(paddedSize - readSize, std::ios::cur);
+
+            char* headerPointer = headerBuffer;
+            headerPointer += 0; // 0:  AudioFormat
+            uint32_t audioFormat = littleEndianToInt(headerPointer, 2);
+            headerPointer += 2; // 2:  NumChannels
+            numChannels = littleEndianToInt(headerPointer, 2);
+            headerPointer += 2; // 4:  SampleRate
+            sampleRate = littleEndianToInt(headerPointer, 4);
+            headerPointer += 4; // 8:  ByteRate
+            headerPointer += 4; // 12: BlockAlign
+            headerPointer += 2; // 14: BitsPerSample
+            bitsPerSample = littleEndianToInt(headerPointer, 2);
+
+            // extensible format: https://www.mmsp.ece.mcgill.ca/Documents/AudioFormats/WAVE/WAVE.html
+            if (audioFormat == 0xfffe && readSize >= 40)
+            {
+                headerPointer += 2; // 16: cbSize (22 for extensible)
+                headerPointer += 2; // 18: ValidBitsPerSample
+                headerPointer += 2; // 20: ChannelMask
+                headerPointer += 4; // 24: SubFormat
+
+                // the first 2 bytes of the SubFormat GUID hold the actual format code
+                audioFormat = littleEndianToInt(headerPointer, 2);
+            }
+
+            // only support PCM and IEEE float formats
+            assert(audioFormat == 0x1 || audioFormat == 0x3);
+            ieeeFloat = audioFormat == 0x3;
+            foundFormat = true;
+        }
+        else if (chunkId == 0x64617461) // data
+        {
+            dataOffset = byteStream.tellg();
+            dataSize = chunkSize == 0xffffffff && foundDs64 ? ds64DataSize : chunkSize;
+            break;
+        }
+        else
+        {
+            byteStream.seekg(paddedSize, std::ios::cur);
+        }
+    }
+
+    // the fmt chunk must come before the data chunk
+    assert(foundFormat && dataOffset != 0);
+    if (!foundFormat || dataOffset == 0 || bitsPerSample == 0 || numChannels == 0)
+    {
+        return;
+    }
+
+    // files which were not closed properly can claim more data than they contain
+    byteStream.seekg(0, std::ios::end);
+    uint64_t fileSize = (uint64_t) byteStream.tellg();
+    dataSize = std::min(dataSize, fileSize - dataOffset);
+
+    uint32_t blockAlign = numChannels * (bitsPerSample / 8);
+    numSamples = dataSize / blockAlign;
+    seek(0);
+}
+
+uint64_t WaveReader::read(double* const* destination, uint64_t count)
+{
+    count = std::min(count, numSamples - position);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    PROFILE_SCOPE("decode");
+
+    // read as many frames as fit in the buffer at a time,
+    // then convert them one channel at a time
+    // each thread converts its own range of whole frames into its own region of the destination,
+    // so no locking is needed
+    uint32_t bytesPerSample = bitsPerSample / 8;
+    uint32_t blockAlign = numChannels * bytesPerSample;
+    uint64_t numThreads = pool != nullptr ? pool->getNumThreads() : 1;
+    uint64_t framesPerRange = std::max<uint64_t>(1, READ_BUFFER_SIZE / blockAlign);
+    uint64_t framesPerBuffer = std::min(framesPerRange * numThreads, count);
+    buffer.resize(framesPerBuffer * blockAlign);
+
+    for (uint64_t start = 0; start < count; start += framesPerBuffer)
+    {
+        uint64_t frames = std::min(framesPerBuffer, count - start);
+        {
+            PROFILE_SCOPE("read from disk");
+            byteStream.read(buffer.data(), frames * blockAlign);
+        }
+
+        auto decodeRange = [&](std::size_t range)
+            {
+                PROFILE_SCOPE("decode range");
+                uint64_t first = range * framesPerRange;
+                uint64_t rangeFrames = std::min(framesPerRange, frames - first);
+                char* source = &buffer[first * blockAlign];
+                for (uint32_t j = 0; j < numChannels; j++)
+                {
+                    decodeSamples(source + j * bytesPerSample, destination[j] + start + first, rangeFrames, blockAlign);
+                }
+            };
+
+        std::size_t numRanges = (frames + framesPerRange - 1) / framesPerRange;
+        if (pool != nullptr)
+        {
+            pool->parallelFor(numRanges, decodeRange);
+        }
+        else
+        {
+            for (std::size_t range = 0; range < numRanges; range++)
+            {
+                decodeRange(range);
+            }
+        }
+    }
+
+    position += count;
+    return count;
+}
+
+void WaveReader::decodeSamples(char* source, double* destination, uint64_t count, int blockAlign)
+{
+    // normalize data to [-1.0, 1.0)
+    // the format is checked once per block instead of once per sample
+    if (ieeeFloat)
+    {
+        // if IEEE, the float should already be [-1.0, 1,0)
+        // reinterpret the bits instead of converting the integer value
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint32_t rawValue = littleEndianToInt(source + i * blockAlign, 4);
+            float value;
+            std::memcpy(&value, &rawValue, sizeof(float));
+            destination[i] = static_cast<double>(value);
+        }
+        return;
+    }
+
+    // lifted from scipy: https://github.com/scipy/scipy/blob/v1.13.1/scipy/io/wavfile.py#L541-L706
+    // =====================  ===========  ===========  =============
+    //     WAV format            Min          Max       NumPy dtype
+    // =====================  ===========  ===========  =============
+    // 32-bit integer PCM     -2147483648  +2147483647  int32
+    // 24-bit integer PCM     -2147483648  +2147483392  int32
+    // 16-bit integer PCM     -32768       +32767       int16
+    // 8-bit integer PCM      0            255          uint8
+    // =====================  ===========  ===========  =============
+    if (bitsPerSample == 8)
+    {
+        // values in the range [0, 255]
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint32_t rawValue = littleEndianToInt(source + i * blockAlign, 1);
+            destination[i] = (double) rawValue / 255.0 * 2.0 - 1.0;
+        }
+    }
+    else if (bitsPerSample == 16)
+    {
+        // values in the range [-32768, 32767]
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint32_t rawValue = littleEndianToInt(source + i * blockAlign, 2);
+            destination[i] = (double) static_cast<int16_t>(rawValue) / 32768.0;
+        }
+    }
+    else if (bitsPerSample == 24)
+    {
+        // values in the range [-2147483648, 2147483392]
+        // right shift so the range becomes [-2147483648, 2147483647]
+        // static_cast is necessary because the values are stored in 2's complement
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint32_t rawValue = littleEndianToInt(source + i * blockAlign, 3);
+            destination[i] = (double) ((static_cast<int32_t>(rawValue << 8)) / 2147483648.0);
+        }
+    }
+    else if (bitsPerSample == 32)
+    {
+        // values in the range [-2147483648, 2147483647]
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint32_t rawValue = littleEndianToInt(source + i * blockAlign, 4);
+            destination[i] = (double) ((static_cast<int32_t>(rawValue)) / 2147483648.0);
+        }
+    }
+}
+
+uint32_t WaveReader::littleEndianToInt(char* bytes, int size)
+{
+    // least significant byte at smallest address
+    uint32_t value = 0;
+    for (int i = 0; i < size; i++)
+    {
+        // bitmask is necessary to prevent sign extension
+        uint32_t offset = i * 8;
+        uint32_t mask = 0xff << offset;
+        value |= (bytes[i] << offset) & mask;
+    }
+    return value;
+}
+
+uint64_t WaveReader::littleEndianToLong(char* bytes)
+{
+    // 64-bit sizes are stored as 2 little endian 32-bit halves
+    uint64_t low = littleEndianToInt(bytes, 4);
+    uint64_t high = littleEndianToInt(bytes + 4, 4);
+    return low | (high << 32);
+}
+
+uint32_t WaveReader::bigEndianToInt(char* bytes, int size)
+{
+    // most significant byte at biggest address
+    uint32_t value = 0;
+    for (int i = 0; i < size; i++)
+    {
+        // bitmask is necessary to prevent sign extension
+        uint32_t offset = (size - i - 1) * 8;
+        uint32_t mask = 0xff << offset;
+        value |= (bytes[i] << offset) & mask;
+    }
+    return value;
+}
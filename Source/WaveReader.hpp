@@ -0,0 +1,62 @@
+#ifndef WAVEREADER_HEADER
+#define WAVEREADER_HEADER
+
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class WaveReader
+{
+public:
+    // largest fmt chunk that is parsed (WAVE_FORMAT_EXTENSIBLE), anything after is skipped
+    static const std::size_t FORMAT_CHUNK_MAX_SIZE = 40;
+
+    // samples are read from disk into a buffer of this size before they are converted
+    // with a thread pool, one buffer per thread is read at a time and converted in parallel
+    static const std::size_t READ_BUFFER_SIZE = 1 << 20;
+
+    uint64_t numSamples;
+    uint32_t numChannels;
+    uint32_t sampleRate;
+
+    WaveReader(std::string filename);
+
+    // reads up to count frames from the current position into planar channels
+    // returns the number of frames read, which is less than count at the end of the data
+    uint64_t read(double* const* destination, uint64_t count);
+    void seek(uint64_t frame);
+    uint64_t getPosition();
+
+    uint32_t getBitsPerSample();
+    bool isIeeeFloat();
+
+    // converts samples on the pool's threads, or only on the calling thread if pool is nullptr
+    void setThreadPool(ThreadPool* pool);
+
+private:
+    std::ifstream byteStream;
+    std::vector<char> buffer;
+    uint64_t position;
+    ThreadPool* pool;
+
+    // uint32_t since header data can contain up to 4 bytes = 32 bits
+    uint32_t bitsPerSample;
+    bool ieeeFloat;
+
+    // position and size of the data chunk in the file
+    // these are 64-bit since RF64/BW64 files can be larger than 4 GB
+    std::streamoff dataOffset;
+    uint64_t dataSize;
+
+    void readHeader();
+    void decodeSamples(char* source, double* destination, uint64_t count, int blockAlign);
+
+    uint32_t littleEndianToInt(char* bytes, int size);
+    uint64_t littleEndianToLong(char* bytes);
+    uint32_t bigEndianToInt(char* bytes, int size);
+};
+
+#endif
@@ -0,0 +1,280 @@
+#include "WaveWriter.hpp"
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+WaveWriter::WaveWriter(std::string filename, uint32_t numChannels, uint32_t sampleRate,
+    uint32_t bitsPerSample, bool ieeeFloat, uint64_t numSamples)
+    // std::ios_base::binary is necessary for windows
+    : filename(filename), output(filename, std::ios_base::binary), closed(false), pool(nullptr),
+    numChannels(numChannels), sampleRate(sampleRate), bitsPerSample(bitsPerSample), ieeeFloat(ieeeFloat),
+    numSamplesWritten(0)
+{
+    // only support 8/16/24/32-bit PCM and 32-bit IEEE float
+    assert(ieeeFloat
+        ? bitsPerSample == 32
+        : bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+
+    // unlike a bad format, a missing directory or a read only file is not a programming error
+    if (!output.is_open())
+    {
+        throw std::runtime_error("could not create " + filename);
+    }
+
+    // a plain RIFF header is enough if the whole file is known to fit in 4 GB
+    uint64_t dataSize = numSamples * numChannels * (bitsPerSample / 8);
+    reserveDs64 = numSamples == 0 || dataSize + EXTENSIBLE_HEADER_SIZE > 0xffffffff;
+    writeHeader(numSamples);
+}
+
+WaveWriter::~WaveWriter()
+{
+    // errors can't be reported from a destructor, so files that must be complete are closed explicitly
+    try
+    {
+        close();
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+}
+
+uint64_t WaveWriter::getNumSamplesWritten()
+{
+    return numSamplesWritten;
+}
+
+void WaveWriter::setThreadPool(ThreadPool* pool)
+{
+    this->pool = pool;
+}
+
+void WaveWriter::writeHeader(uint64_t numSamples)
+{
+    // extensible format is required for more than 2 channels or more than 16 bits
+    // https://learn.microsoft.com/en-us/windows/win32/api/mmreg/ns-mmreg-waveformatextensible
+    bool extensible = numChannels > 2 || bitsPerSample > 16;
+    uint32_t formatCode = ieeeFloat ? 0x3 : 0x1;
+
+    uint32_t bytesPerSample = bitsPerSample / 8;
+    uint32_t blockAlign = numChannels * bytesPerSample;
+    uint32_t byteRate = sampleRate * blockAlign;
+    uint32_t subchunk1Size = extensible ? 40 : 16;
+    uint64_t subchunk2Size = numSamples * blockAlign;
+
+    // chunks must be word aligned, so odd sized data is followed by a pad byte
+    uint64_t padSize = subchunk2Size & 1;
+    uint64_t ds64Size = reserveDs64 ? DS64_CHUNK_SIZE : 0;
+    uint64_t chunkSize = 4 + ds64Size + (8 + subchunk1Size) + (8 + subchunk2Size + padSize);
+
+    // RF64 replaces the 32-bit sizes with 0xffffffff and stores the real sizes in the ds64 chunk
+    // https://tech.ebu.ch/docs/tech/tech3306v1_1.pdf
+    bool rf64 = chunkSize > 0xffffffff;
+    assert(!rf64 || reserveDs64);
+
+    char header[EXTENSIBLE_HEADER_SIZE + DS64_CHUNK_SIZE] = {};
+    char* headerPointer = header;
+    std::memcpy(headerPointer, rf64 ? "RF64" : "RIFF", 4); // 0:  ChunkID
+    intToLittleEndian(headerPointer + 4, rf64 ? 0xffffffff : (uint32_t) chunkSize, 4); // 4:  ChunkSize
+    std::memcpy(headerPointer + 8, "WAVE", 4); // 8:  Format
+    headerPointer += 12;
+
+    if (reserveDs64)
+    {
+        // the chunk is kept as JUNK until the sizes no longer fit in 32 bits
+        std::memcpy(headerPointer, rf64 ? "ds64" : "JUNK", 4); // 12: ds64 ChunkID
+        intToLittleEndian(headerPointer + 4, DS64_CHUNK_SIZE - 8, 4); // 16: ds64 ChunkSize
+        if (rf64)
+        {
+            longToLittleEndian(headerPointer + 8, chunkSize); // 20: RiffSize
+            longToLittleEndian(headerPointer + 16, subchunk2Size); // 28: DataSize
+            longToLittleEndian(headerPointer + 24, numSamples); // 36: SampleCount
+            intToLittleEndian(headerPointer + 32, 0, 4); // 44: TableLength
+        }
+        headerPointer += DS64_CHUNK_SIZE;
+    }
+
+    // offsets below are for a plain RIFF header
+    std::memcpy(headerPointer, "fmt ", 4); // 12: Subchunk1ID
+    intToLittleEndian(headerPointer + 4, subchunk1Size, 4); // 16: Subchunk1Size
+    intToLittleEndian(headerPointer + 8, extensible ? 0xfffe : formatCode, 2); // 20: AudioFormat
+    intToLittleEndian(headerPointer + 10, numChannels, 2); // 22: NumChannels
+    intToLittleEndian(headerPointer + 12, sampleRate, 4); // 24: SampleRate
+    intToLittleEndian(headerPointer + 16, byteRate, 4); // 28: ByteRate
+    intToLittleEndian(headerPointer + 20, blockAlign, 2); // 32: BlockAlign
+    intToLittleEndian(headerPointer + 22, bitsPerSample, 2); // 34: BitsPerSample
+    headerPointer += 24;
+
+    if (extensible)
+    {
+        // KSDATAFORMAT_SUBTYPE_PCM / KSDATAFORMAT_SUBTYPE_IEEE_FLOAT
+        // only the first 2 bytes differ between the 2 GUIDs
+        static const char subFormatSuffix[14] = {
+            0x00, 0x00, 0x00, 0x00, 0x10, 0x00, (char) 0x80,
+            0x00, 0x00, (char) 0xaa, 0x00, 0x38, (char) 0x9b, 0x71
+        };
+
+        intToLittleEndian(headerPointer, 22, 2); // 36: cbSize
+        intToLittleEndian(headerPointer + 2, bitsPerSample, 2); // 38: ValidBitsPerSample
+        intToLittleEndian(headerPointer + 4, 0, 4); // 40: ChannelMask (unspecified)
+        intToLittleEndian(headerPointer + 8, formatCode, 2); // 44: SubFormat
+        std::memcpy(headerPointer + 10, subFormatSuffix, 14);
+        headerPointer += 24;
+    }
+
+    std::memcpy(headerPointer, "data", 4); // 36: Subchunk2ID (60 if extensible)
+    intToLittleEndian(headerPointer + 4, rf64 ? 0xffffffff : (uint32_t) subchunk2Size, 4); // 40: Subchunk2Size (64 if extensible)
+    headerPointer += 8;
+
+    output.seekp(0);
+    output.write(header, headerPointer - header);
+}
+
+void WaveWriter::write(const double* const* source, uint64_t count)
+{
+    assert(!closed);
+    PROFILE_SCOPE("encode");
+
+    // encode as many frames as fit in the buffer before each write,
+    // so that large files are written with only a few calls
+    // each thread encodes its own range of whole frames into its own region of the buffer,
+    // so no locking is needed
+    uint32_t bytesPerSample = bitsPerSample / 8;
+    uint32_t blockAlign = numChannels * bytesPerSample;
+    uint64_t numThreads = pool != nullptr ? pool->getNumThreads() : 1;
+    uint64_t framesPerRange = std::max<uint64_t>(1, WRITE_BUFFER_SIZE / blockAlign);
+    uint64_t framesPerBuffer = std::min(framesPerRange * numThreads, std::max<uint64_t>(1, count));
+    buffer.resize(framesPerBuffer * blockAlign);
+
+    for (uint64_t start = 0; start < count; start += framesPerBuffer)
+    {
+        uint64_t frames = std::min(framesPerBuffer, count - start);
+
+        auto encodeRange = [&](std::size_t range)
+            {
+                PROFILE_SCOPE("encode range");
+                uint64_t first = range * framesPerRange;
+                uint64_t rangeFrames = std::min(framesPerRange, frames - first);
+                char* destination = &buffer[first * blockAlign];
+                for (uint32_t j = 0; j < numChannels; j++)
+                {
+                    encodeSamples(source[j] + start + first, destination + j * bytesPerSample, rangeFrames, blockAlign);
+                }
+            };
+
+        std::size_t numRanges = (frames + framesPerRange - 1) / framesPerRange;
+        if (pool != nullptr)
+        {
+            pool->parallelFor(numRanges, encodeRange);
+        }
+        else
+        {
+            for (std::size_t range = 0; range < numRanges; range++)
+            {
+                encodeRange(range);
+            }
+        }
+        PROFILE_SCOPE("write to disk");
+        output.write(buffer.data(), frames * blockAlign);
+    }
+    numSamplesWritten += count;
+}
+
+void WaveWriter::close()
+{
+    if (closed)
+    {
+        return;
+    }
+    closed = true;
+
+    uint64_t dataSize = numSamplesWritten * numChannels * (bitsPerSample / 8);
+    if (dataSize & 1)
+    {
+        output.put(0);
+    }
+
+    // the sizes are only known for certain once everything has been written
+    writeHeader(numSamplesWritten);
+    output.close();
+    if (!output)
+    {
+        throw std::runtime_error("could not write " + filename);
+    }
+}
+
+void WaveWriter::encodeSamples(const double* source, char* destination, uint64_t count, int blockAlign)
+{
+    // unnormalize without modifying the samples, so the same file can be written again
+    // the format is checked once per block instead of once per sample
+    if (ieeeFloat)
+    {
+        for (uint64_t i = 0; i < count; i++)
+        {
+            float value = static_cast<float>(source[i]);
+            uint32_t rawValue;
+            std::memcpy(&rawValue, &value, sizeof(float));
+            intToLittleEndian(destination + i * blockAlign, rawValue, 4);
+        }
+    }
+    else if (bitsPerSample == 8)
+    {
+        // values in the range [0, 255]
+        for (uint64_t i = 0; i < count; i++)
+        {
+            double value = std::clamp((source[i] + 1.0) / 2.0 * 255.0, 0.0, 255.0);
+            destination[i * blockAlign] = static_cast<uint8_t>(value);
+        }
+    }
+    else if (bitsPerSample == 16)
+    {
+        // values in the range [-32768, 32767]
+        for (uint64_t i = 0; i < count; i++)
+        {
+            double value = std::clamp(source[i] * 32768.0, -32768.0, 32767.0);
+            intToLittleEndian(destination + i * blockAlign, static_cast<int32_t>(value), 2);
+        }
+    }
+    else if (bitsPerSample == 24)
+    {
+        // values in the range [-8388608, 8388607]
+        for (uint64_t i = 0; i < count; i++)
+        {
+            double value = std::clamp(source[i] * 8388608.0, -8388608.0, 8388607.0);
+            intToLittleEndian(destination + i * blockAlign, static_cast<int32_t>(value), 3);
+        }
+    }
+    else if (bitsPerSample == 32)
+    {
+        // values in the range [-2147483648, 2147483647]
+        for (uint64_t i = 0; i < count; i++)
+        {
+            double value = std::clamp(source[i] * 2147483648.0, -2147483648.0, 2147483647.0);
+            intToLittleEndian(destination + i * blockAlign, static_cast<int32_t>(value), 4);
+        }
+    }
+}
+
+void WaveWriter::intToLittleEndian(char* bytes, uint32_t value, int size)
+{
+    // least significant byte at smallest address
+    uint32_t mask = (1 << 8) - 1;
+    for (int i = 0; i < size; i++)
+    {
+        bytes[i] = value & mask;
+        value >>= 8;
+    }
+}
+
+void WaveWriter::longToLittleEndian(char* bytes, uint64_t value)
+{
+    // 64-bit sizes are stored as 2 little endian 32-bit halves
+    intToLittleEndian(bytes, (uint32_t) value, 4);
+    intToLittleEndian(bytes + 4, (uint32_t) (value >> 32), 4);
+}
@@ -0,0 +1,66 @@
+#ifndef WAVEWRITER_HEADER
+#define WAVEWRITER_HEADER
+
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class WaveWriter
+{
+public:
+    // header size when the fmt chunk uses WAVE_FORMAT_EXTENSIBLE (40 bytes instead of 16)
+    static const std::size_t EXTENSIBLE_HEADER_SIZE = 68;
+
+    // size of the ds64 chunk, which is also reserved as a JUNK chunk when the length is unknown
+    static const std::size_t DS64_CHUNK_SIZE = 36;
+
+    // samples are encoded into a buffer of this size before each write to disk
+    // with a thread pool, one buffer per thread is encoded in parallel before each write
+    static const std::size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+    // numSamples is the expected length of the file
+    // if it is 0, space is reserved so the header can be turned into RF64 when the file is closed
+    // throws std::runtime_error if the file can't be created (e.g. its directory doesn't exist)
+    WaveWriter(std::string filename, uint32_t numChannels, uint32_t sampleRate,
+        uint32_t bitsPerSample, bool ieeeFloat, uint64_t numSamples = 0);
+    ~WaveWriter();
+
+    // appends count frames from planar channels
+    void write(const double* const* source, uint64_t count);
+
+    // pads the data chunk and rewrites the header with the final sizes
+    // throws std::runtime_error if anything failed to be written (e.g. the disk is full)
+    void close();
+
+    uint64_t getNumSamplesWritten();
+
+    // converts samples on the pool's threads, or only on the calling thread if pool is nullptr
+    void setThreadPool(ThreadPool* pool);
+
+private:
+    std::string filename;
+    std::ofstream output;
+    std::vector<char> buffer;
+    bool closed;
+    ThreadPool* pool;
+
+    uint32_t numChannels;
+    uint32_t sampleRate;
+    uint32_t bitsPerSample;
+    bool ieeeFloat;
+    uint64_t numSamplesWritten;
+
+    // whether the header has room for a ds64 chunk (either as ds64 or JUNK)
+    bool reserveDs64;
+
+    void writeHeader(uint64_t numSamples);
+    void encodeSamples(const double* source, char* destination, uint64_t count, int blockAlign);
+
+    void intToLittleEndian(char* bytes, uint32_t value, int size);
+    void longToLittleEndian(char* bytes, uint64_t value);
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "WaveformOverview.h"
+
+#include "WaveReader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::shared_ptr<const WaveformOverview> WaveformOverview::fromSamples(const SampleBuffer& samples, uint64_t numSamples)
+{
+    auto overview = std::make_shared<WaveformOverview>();
+    std::vector<const double*> channels(samples.getNumChannels());
+    for (std::size_t channel = 0; channel < channels.size(); channel++)
+    {
+        channels[channel] = samples.getChannel(channel);
+    }
+    overview->add(channels.data(), (uint32_t) channels.size(), (std::size_t) std::min<uint64_t>(numSamples, samples.getNumSamples()));
+    overview->finish();
+    return overview;
+}
+
+std::shared_ptr<const WaveformOverview> WaveformOverview::fromFile(const std::string& path)
+{
+    auto overview = std::make_shared<WaveformOverview>();
+    WaveReader reader(path);
+    std::size_t blockSize = BASE_BLOCK_SIZE << 10;
+    SampleBuffer block(reader.numChannels, blockSize);
+    std::vector<double*> channels(reader.numChannels);
+    for (uint32_t channel = 0; channel < reader.numChannels; channel++)
+    {
+        channels[channel] = block.getChannel(channel);
+    }
+
+    uint64_t count;
+    while ((count = reader.read(channels.data(), blockSize)) > 0)
+    {
+        overview->add(channels.data(), reader.numChannels, (std::size_t) count);
+    }
+    overview->finish();
+    return overview;
+}
+
+uint64_t WaveformOverview::getNumSamples() const
+{
+    return numSamples;
+}
+
+void WaveformOverview::add(const double* const* channels, uint32_t numChannels, std::size_t count)
+{
+    if (levels.empty())
+    {
+        levels.emplace_back();
+        this->numChannels = numChannels;
+    }
+
+    std::size_t start = 0;
+    while (start < count)
+    {
+        std::size_t blockCount = std::min<std::size_t>(BASE_BLOCK_SIZE - numPending, count - start);
+
+        // each channel's samples are summarised a SIMD register at a time, from the first aligned sample,
+        // and the samples before it and after the last whole register one at a time
+        double low = numPending > 0 ? pending.min : std::numeric_limits<double>::max();
+        double high = numPending > 0 ? pending.max : std::numeric_limits<double>::lowest();
+        double sumOfSquares = pending.sumOfSquares;
+        for (uint32_t channel = 0; channel < numChannels; channel++)
+        {
+            const double* samples = channels[channel] + start;
+            std::size_t i = 0;
+            for (; i < blockCount && !Register::isSIMDAligned(samples + i); i++)
+            {
+                low = std::min(low, samples[i]);
+                high = std::max(high, samples[i]);
+                sumOfSquares += samples[i] * samples[i];
+            }
+
+            Register lows = Register::expand(low);
+            Register highs = Register::expand(high);
+            Register squares = Register::expand(0.0);
+            for (; i + Register::SIMDNumElements <= blockCount; i += Register::SIMDNumElements)
+            {
+                Register values = Register::fromRawArray(samples + i);
+                lows = Register::min(lows, values);
+                highs = Register::max(highs, values);
+                squares = Register::multiplyAdd(squares, values, values);
+            }
+            for (std::size_t lane = 0; lane < Register::SIMDNumElements; lane++)
+            {
+                low = std::min(low, lows.get(lane));
+                high = std::max(high, highs.get(lane));
+            }
+            sumOfSquares += squares.sum();
+
+            for (; i < blockCount; i++)
+            {
+                low = std::min(low, samples[i]);
+                high = std::max(high, samples[i]);
+                sumOfSquares += samples[i] * samples[i];
+            }
+        }
+        pending = { (float) low, (float) high, (float) sumOfSquares };
+        numPending += (int) blockCount;
+        start += blockCount;
+
+        if (numPending == BASE_BLOCK_SIZE)
+        {
+            levels[0].push_back(pending);
+            pending = { 0.0f, 0.0f, 0.0f };
+            numPending = 0;
+        }
+    }
+    numSamples += count;
+}
+
+void WaveformOverview::finish()
+{
+    if (levels.empty())
+    {
+        return;
+    }
+    if (numPending > 0)
+    {
+        levels[0].push_back(pending);
+        numPending = 0;
+    }
+
+    // each level halves the one below until a single block covers the whole clip
+    while (levels.back().size() > 1)
+    {
+        const std::vector<Block>& below = levels.back();
+        std::vector<Block> level((below.size() + 1) / 2);
+        for (std::size_t i = 0; i < level.size(); i++)
+        {
+            level[i] = below[2 * i];
+            if (2 * i + 1 < below.size())
+            {
+                const Block& next = below[2 * i + 1];
+                level[i].min = std::min(level[i].min, next.min);
+                level[i].max = std::max(level[i].max, next.max);
+                level[i].sumOfSquares += next.sumOfSquares;
+            }
+        }
+        levels.push_back(std::move(level));
+    }
+}
+
+void WaveformOverview::getPeaks(double start, double end, Peak* peaks, int numPixels) const
+{
+    std::fill(peaks, peaks + numPixels, Peak());
+    if (levels.empty() || numPixels <= 0 || end <= start)
+    {
+        return;
+    }
+
+    // the coarsest level whose blocks are no wider than a pixel, so each pixel merges only a few blocks
+    double samplesPerPixel = (end - start) / numPixels;
+    int level = 0;
+    while (level + 1 < (int) levels.size() && (double) (BASE_BLOCK_SIZE << (level + 1)) <= samplesPerPixel)
+    {
+        level++;
+    }
+    const std::vector<Block>& blocks = levels[level];
+    double blockSize = (double) (BASE_BLOCK_SIZE << level);
+
+    for (int pixel = 0; pixel < numPixels; pixel++)
+    {
+        double pixelStart = std::max(0.0, start + pixel * samplesPerPixel);
+        double pixelEnd = std::min((double) numSamples, pixelStart + samplesPerPixel);
+        if (pixelStart >= numSamples)
+        {
+            break;
+        }
+
+        std::size_t first = (std::size_t) (pixelStart / blockSize);
+        std::size_t last = std::max(first + 1, (std::size_t) std::ceil(pixelEnd / blockSize));
+        last = std::min(last, blocks.size());
+
+        Peak& peak = peaks[pixel];
+        peak.min = std::numeric_limits<float>::max();
+        peak.max = std::numeric_limits<float>::lowest();
+        double sumOfSquares = 0.0;
+        for (std::size_t i = first; i < last; i++)
+        {
+            peak.min = std::min(peak.min, blocks[i].min);
+            peak.max = std::max(peak.max, blocks[i].max);
+            sumOfSquares += blocks[i].sumOfSquares;
+        }
+        double numSummarised = std::min((double) numSamples, last * blockSize) - first * blockSize;
+        peak.rms = (float) std::sqrt(sumOfSquares / (numSummarised * numChannels));
+    }
+}
\ No newline at end of file
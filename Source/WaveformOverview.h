@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SampleBuffer.hpp"
+
+//==============================================================================
+/**
+    A pyramid of min/max/RMS summaries of a clip, so it can be drawn at any zoom level
+    in time proportional to the number of pixels instead of the number of samples.
+
+    The first level summarises blocks of BASE_BLOCK_SIZE samples and every level above
+    it merges pairs of blocks from the one below. All channels are summarised together.
+    An overview is built once, in a single pass over the samples, and never modified.
+*/
+class WaveformOverview
+{
+public:
+  static const int BASE_BLOCK_SIZE = 64;
+
+  struct Peak
+  {
+    float min = 0.0f;
+    float max = 0.0f;
+    float rms = 0.0f;
+  };
+
+  // not real-time safe
+  static std::shared_ptr<const WaveformOverview> fromSamples(const SampleBuffer& samples, uint64_t numSamples);
+
+  // reads the file one block at a time, so it never has to fit in memory
+  static std::shared_ptr<const WaveformOverview> fromFile(const std::string& path);
+
+  uint64_t getNumSamples() const;
+
+  // fills one peak per pixel for the samples in [start, end)
+  void getPeaks(double start, double end, Peak* peaks, int numPixels) const;
+
+private:
+  struct Block
+  {
+    float min;
+    float max;
+    float sumOfSquares;
+  };
+
+  uint64_t numSamples = 0;
+  uint32_t numChannels = 0;
+
+  // level k has blocks of BASE_BLOCK_SIZE << k samples
+  std::vector<std::vector<Block>> levels;
+
+  // the block being filled while the first level is built
+  Block pending = { 0.0f, 0.0f, 0.0f };
+  int numPending = 0;
+
+  using Register = juce::dsp::SIMDRegister<double>;
+
+  void add(const double* const* channels, uint32_t numChannels, std::size_t count);
+  void finish();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformOverview)
+};
\ No newline at end of file
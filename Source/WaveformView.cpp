@@ -0,0 +1,62 @@
+#include "WaveformView.h"
+
+WaveformView::WaveformView(OverviewFunction getOverview)
+    : getOverview(std::move(getOverview))
+{
+    setOpaque(true);
+    startTimerHz(REFRESH_RATE_HZ);
+}
+
+WaveformView::~WaveformView()
+{
+    stopTimer();
+}
+
+void WaveformView::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+    float centre = getHeight() / 2.0f;
+    g.setColour(juce::Colours::darkgrey);
+    g.drawHorizontalLine((int) centre, 0.0f, (float) getWidth());
+    if (overview == nullptr)
+    {
+        return;
+    }
+
+    // samples are in [-1, 1], so half the height is full scale
+    float scale = getHeight() / 2.0f;
+    for (int x = 0; x < (int) peaks.size(); x++)
+    {
+        const WaveformOverview::Peak& peak = peaks[x];
+        g.setColour(juce::Colours::skyblue);
+        g.drawVerticalLine(x, centre - peak.max * scale, centre - peak.min * scale);
+        g.setColour(juce::Colours::white);
+        g.drawVerticalLine(x, centre - peak.rms * scale, centre + peak.rms * scale);
+    }
+}
+
+void WaveformView::resized()
+{
+    updatePeaks();
+}
+
+void WaveformView::timerCallback()
+{
+    std::shared_ptr<const WaveformOverview> latest = getOverview();
+    if (latest != overview)
+    {
+        overview = latest;
+        updatePeaks();
+        repaint();
+    }
+}
+
+void WaveformView::updatePeaks()
+{
+    // the whole clip fits the width of the view
+    peaks.resize((std::size_t) juce::jmax(0, getWidth()));
+    if (overview != nullptr)
+    {
+        overview->getPeaks(0.0, (double) overview->getNumSamples(), peaks.data(), (int) peaks.size());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "WaveformOverview.h"
+
+//==============================================================================
+/**
+    Draws the overview of the clip that is playing, min/max in the background and
+    RMS on top of it.
+
+    A 60 Hz timer picks up a new overview when one is published, and the peaks are only
+    looked up again when the overview or the width changes, so painting is one line per
+    pixel however long the clip is.
+*/
+class WaveformView : public juce::Component, private juce::Timer
+{
+public:
+  static const int REFRESH_RATE_HZ = 60;
+
+  using OverviewFunction = std::function<std::shared_ptr<const WaveformOverview>()>;
+
+  // getOverview is polled on the message thread, and returns nullptr when there is nothing to draw
+  WaveformView(OverviewFunction getOverview);
+  ~WaveformView() override;
+
+  void paint(juce::Graphics& g) override;
+  void resized() override;
+
+private:
+  OverviewFunction getOverview;
+  std::shared_ptr<const WaveformOverview> overview;
+  std::vector<WaveformOverview::Peak> peaks;
+
+  void timerCallback() override;
+  void updatePeaks();
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformView)
+};
\ No newline at end of file